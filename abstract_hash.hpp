@@ -3,6 +3,11 @@
 
 #include <string>
 #include <stdexcept>
+#include <cstddef>
+#include <functional>
+#include <thread>
+#include <vector>
+#include <algorithm>
 
 class AbstractHash {
 public:
@@ -11,17 +16,98 @@ public:
     virtual void erase(const std::string &key) = 0;
     virtual int find(const std::string &key) const = 0;
     
-    // 可选：默认实现 contains 接口
-    virtual bool contains(const std::string &key) const {
+    // 不抛异常的查找：命中时写入 value 并返回 true。
+    // 默认实现包装 find；各表覆盖为直接查找，未命中路径不再经过异常
+    virtual bool tryFind(const std::string &key, int &value) const {
         try {
-            find(key);
+            value = find(key);
             return true;
         } catch(const std::runtime_error &) {
             return false;
         }
     }
     
+    // 可选：默认实现 contains 接口
+    virtual bool contains(const std::string &key) const {
+        int value;
+        return tryFind(key, value);
+    }
+    
+    // 批量查找：结果写入 values[i] / found[i]，返回命中数。
+    // group_size 为同时在途的查找数；默认实现逐个调用 find，
+    // 链式结构的表可覆盖为交错推进多个查找以掩盖访存延迟
+    virtual size_t findBatch(const std::string *keys, size_t count, int *values, bool *found,
+                             size_t group_size = 8) const {
+        (void)group_size;
+        size_t hits = 0;
+        for (size_t i = 0; i < count; i++) {
+            try {
+                values[i] = find(keys[i]);
+                found[i] = true;
+                hits++;
+            } catch (const std::runtime_error &) {
+                found[i] = false;
+            }
+        }
+        return hits;
+    }
+    
+    // 调用方已算出 string_hash = std::hash<std::string>{}(key) 时的查找，
+    // 供过滤器等外层结构复用同一个 hash；内部 hash 相同的表覆盖它省掉第二次整键 hash，
+    // 默认实现忽略 string_hash
+    virtual bool tryFindHashed(const std::string &key, size_t string_hash, int &value) const {
+        (void)string_hash;
+        return tryFind(key, value);
+    }
+    
+    // 批量版本按指针传入键，外层结构筛选后的键不必复制成连续数组；
+    // string_hashes 可以为空，由表自己计算。默认实现逐个调用 tryFindHashed
+    virtual size_t findBatchHashed(const std::string *const *keys, const size_t *string_hashes, size_t count,
+                                   int *values, bool *found, size_t group_size = 8) const {
+        (void)group_size;
+        size_t hits = 0;
+        for (size_t i = 0; i < count; i++) {
+            found[i] = string_hashes ? tryFindHashed(*keys[i], string_hashes[i], values[i])
+                                     : tryFind(*keys[i], values[i]);
+            hits += found[i];
+        }
+        return hits;
+    }
+    
+    // 遍历所有表项，每个键恰好访问一次；遍历期间不得修改表
+    using EntryVisitor = std::function<void(const std::string &key, int value)>;
+    virtual void forEach(const EntryVisitor &visit) const = 0;
+    
+    // 并行遍历：把物理存储切成连续区间分给 threads 个线程（0 表示硬件线程数），
+    // 每个线程顺序扫描自己的区间。visit 会被并发调用，须自行保证线程安全且不抛异常；
+    // 默认实现退化为串行 forEach
+    virtual void parallelForEach(const EntryVisitor &visit, unsigned threads = 0) const {
+        (void)threads;
+        forEach(visit);
+    }
+    
     virtual ~AbstractHash() {}
+    
+protected:
+    // 把 [0, count) 均分为至多 threads 段，每段在一个线程上调用 body(begin, end)；
+    // 只有一段时直接在调用线程上执行
+    template <class Body>
+    static void forEachRange(size_t count, unsigned threads, Body body) {
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        size_t parts = std::max<size_t>(1, std::min<size_t>(threads, count));
+        if (parts == 1) {
+            body(static_cast<size_t>(0), count);
+            return;
+        }
+        std::vector<std::thread> pool;
+        for (size_t t = 0; t < parts; t++) {
+            pool.emplace_back(body, count * t / parts, count * (t + 1) / parts);
+        }
+        for (auto &th : pool) {
+            th.join();
+        }
+    }
 };
 
 #endif // ABSTRACT_HASH_HPP
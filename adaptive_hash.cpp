@@ -0,0 +1,303 @@
+#include "adaptive_hash.hpp"
+#include "simple_hash.hpp"
+#include "elastic_hash.hpp"
+#include "dynamic_mph.hpp"
+#include <vector>
+#include <algorithm>
+#include <random>
+
+namespace {
+
+// 键数少于该值时冻结的收益不抵构造 MPH 的开销
+const size_t kMinStaticSize = 1024;
+// STATIC 模式下写比例超过 1/20 时迁回动态实现
+const size_t kStaticWriteRatioInverse = 20;
+// 冻结后只读窗口的平均耗时超过冻结前的 1.1 倍时迁回
+const double kStaticSlowdownLimit = 1.1;
+const size_t kMinCapacity = 101;
+const int kElasticBucketSize = 16;
+// 冻结前在后台线程里用这么多个随机抽样的键比较新旧实现的查询耗时
+const size_t kProbeSampleSize = 8192;
+
+} // namespace
+
+AdaptiveHash::AdaptiveHash(size_t initial_capacity, size_t memory_limit, size_t window)
+    : backend(new SimpleHash(std::max(initial_capacity, kMinCapacity))), mode(Mode::CHAINED),
+      capacity(std::max(initial_capacity, kMinCapacity)), count(0), migrating(false),
+      pending_plan{Mode::CHAINED, 0}, pending_ready(false), migration_count(0),
+      memory_limit(memory_limit), window(std::max<size_t>(window, 1)),
+      window_ops(0), window_reads(0), window_misses(0), window_writes(0),
+      window_start(std::chrono::steady_clock::now()), window_start_migrations(0),
+      dynamic_read_ns(0), static_rejected(false) {}
+
+AdaptiveHash::~AdaptiveHash() {
+    if (migration_thread.joinable())
+        migration_thread.join();
+}
+
+const char *AdaptiveHash::modeName(Mode mode) {
+    switch (mode) {
+    case Mode::CHAINED:
+        return "CHAINED";
+    case Mode::ELASTIC:
+        return "ELASTIC";
+    case Mode::STATIC:
+        return "STATIC";
+    }
+    return "UNKNOWN";
+}
+
+bool AdaptiveHash::lookup(const std::string &key, int &value) const {
+    if (migrating) {
+        auto it = delta.find(key);
+        if (it != delta.end()) {
+            if (it->second.erased)
+                return false;
+            value = it->second.value;
+            return true;
+        }
+    }
+    return backend->tryFind(key, value);
+}
+
+// 每次操作开始时检查后台构造是否完成；只是一次原子读
+void AdaptiveHash::poll() const {
+    if (migrating && pending_ready.load(std::memory_order_acquire))
+        finishMigration();
+}
+
+// 回放迁移期间的写入并切换到新实现；
+// 后台线程放弃冻结或构造失败时（pending 为空）写入回放到旧实现，写操作恢复前不再尝试冻结
+void AdaptiveHash::finishMigration() const {
+    migration_thread.join();
+    AbstractHash &target = pending ? *pending : *backend;
+    for (const auto &item : delta) {
+        int value;
+        if (!item.second.erased)
+            target.insert(item.first, item.second.value);
+        else if (target.tryFind(item.first, value))
+            target.erase(item.first);
+    }
+    delta.clear();
+    migrating = false;
+    pending_ready.store(false, std::memory_order_relaxed);
+    if (!pending) {
+        static_rejected = true;
+        return;
+    }
+    backend = std::move(pending);
+    mode = pending_plan.mode;
+    capacity = pending_plan.capacity;
+    migration_count++;
+}
+
+void AdaptiveHash::insert(const std::string &key, int value) {
+    poll();
+    int old;
+    bool existed = lookup(key, old);
+    if (migrating)
+        delta[key] = DeltaEntry{value, false};
+    else
+        backend->insert(key, value);
+    if (!existed)
+        count++;
+    recordOp(true);
+}
+
+void AdaptiveHash::erase(const std::string &key) {
+    poll();
+    int old;
+    if (!lookup(key, old))
+        throw std::runtime_error("Key not found in AdaptiveHash");
+    if (migrating)
+        delta[key] = DeltaEntry{0, true};
+    else
+        backend->erase(key);
+    count--;
+    recordOp(true);
+}
+
+int AdaptiveHash::find(const std::string &key) const {
+    int value;
+    if (!tryFind(key, value))
+        throw std::runtime_error("Key not found in AdaptiveHash");
+    return value;
+}
+
+bool AdaptiveHash::tryFind(const std::string &key, int &value) const {
+    poll();
+    bool found = lookup(key, value);
+    window_reads++;
+    if (!found)
+        window_misses++;
+    recordOp(false);
+    return found;
+}
+
+void AdaptiveHash::forEach(const EntryVisitor &visit) const {
+    poll();
+    if (!migrating) {
+        backend->forEach(visit);
+        return;
+    }
+    for (const auto &item : delta) {
+        if (!item.second.erased)
+            visit(item.first, item.second.value);
+    }
+    backend->forEach([&](const std::string &key, int value) {
+        if (delta.count(key) == 0)
+            visit(key, value);
+    });
+}
+
+void AdaptiveHash::waitForMigration() {
+    if (migrating) {
+        while (!pending_ready.load(std::memory_order_acquire))
+            std::this_thread::yield();
+        finishMigration();
+    }
+}
+
+void AdaptiveHash::recordOp(bool write) const {
+    if (write)
+        window_writes++;
+    if (++window_ops == window) {
+        window_ops = 0;
+        adapt();
+    }
+}
+
+void AdaptiveHash::adapt() const {
+    size_t reads = window_reads, misses = window_misses, writes = window_writes;
+    window_reads = window_misses = window_writes = 0;
+    // 窗口内发生过迁移时后台构造会抢占 CPU，该窗口的耗时不作为比较依据
+    auto now = std::chrono::steady_clock::now();
+    double ns_per_op = std::chrono::duration<double, std::nano>(now - window_start).count()
+        / std::max<size_t>(reads + writes, 1);
+    bool clean = !migrating && migration_count == window_start_migrations;
+    window_start = now;
+    window_start_migrations = migration_count;
+    if (migrating)
+        return;
+    
+    Plan plan = choosePlan(reads, misses, writes, ns_per_op, clean);
+    if (plan.mode == mode && plan.capacity == capacity)
+        return;
+    
+    // 后台线程只读取旧实现；迁移期间的写入进入增量层，不会修改 backend
+    migrating = true;
+    pending_plan = plan;
+    const AbstractHash *source = backend.get();
+    size_t expected = count;
+    // 构造中的任何异常（MPH 构造失败、bad_alloc 等）都留在后台线程里，
+    // pending 为空，迁移结束时继续使用当前实现
+    migration_thread = std::thread([this, plan, source, expected]() {
+        try {
+            pending = makeBackend(plan, *source, expected);
+        } catch (const std::exception &) {
+            pending.reset();
+        }
+        pending_ready.store(true, std::memory_order_release);
+    });
+}
+
+AdaptiveHash::Plan AdaptiveHash::choosePlan(size_t reads, size_t misses, size_t writes,
+                                            double ns_per_op, bool clean) const {
+    size_t ops = reads + writes;
+    bool read_only = writes == 0 && reads > 0;
+    if (writes > 0)
+        static_rejected = false;
+    
+    if (mode == Mode::STATIC) {
+        if (read_only && clean && ns_per_op > dynamic_read_ns * kStaticSlowdownLimit) {
+            static_rejected = true;
+            return dynamicPlan(reads, misses);
+        }
+        if (writes * kStaticWriteRatioInverse <= ops)
+            return Plan{Mode::STATIC, 0};
+        return dynamicPlan(reads, misses);
+    }
+    
+    // 先在动态模式下测得一个干净的只读窗口作为基准，下一个只读窗口再冻结
+    if (read_only && clean) {
+        bool have_baseline = dynamic_read_ns > 0;
+        dynamic_read_ns = ns_per_op;
+        if (have_baseline && !static_rejected && count >= kMinStaticSize)
+            return Plan{Mode::STATIC, 0};
+    } else if (!read_only) {
+        dynamic_read_ns = 0;
+    }
+    return dynamicPlan(reads, misses);
+}
+
+AdaptiveHash::Plan AdaptiveHash::dynamicPlan(size_t reads, size_t misses) const {
+    if (mode == Mode::ELASTIC)
+        return Plan{Mode::ELASTIC, 0};
+    
+    // 未命中要走完整条链，未命中超过一半时把目标负载因子从 1 降到 0.5
+    size_t load_divisor = (reads > 0 && misses * 2 > reads) ? 2 : 1;
+    size_t target = capacity;
+    if (mode == Mode::STATIC || count * load_divisor > capacity)
+        target = std::max(kMinCapacity, count * load_divisor * 2);
+    
+    // 链数组本身（空链也占一个 vector 头）加表项的估计内存
+    size_t estimate = target * sizeof(std::vector<HashEntry>) + count * sizeof(HashEntry);
+    if (memory_limit != 0 && estimate > memory_limit)
+        return Plan{Mode::ELASTIC, 0};
+    return Plan{Mode::CHAINED, target};
+}
+
+std::unique_ptr<AbstractHash> AdaptiveHash::makeBackend(const Plan &plan, const AbstractHash &source, size_t count) {
+    if (plan.mode == Mode::STATIC) {
+        std::vector<std::string> keys;
+        std::vector<int> values;
+        keys.reserve(count);
+        values.reserve(count);
+        source.forEach([&](const std::string &key, int value) {
+            keys.push_back(key);
+            values.push_back(value);
+        });
+        // 写比例升高时由 AdaptiveHash 负责迁出，不让静态层自己在后台反复重建
+        size_t rebuild_threshold = std::max(count, kMinStaticSize);
+        // MPH 构造失败时抛出异常，由 adapt 中的后台线程捕获，不冻结
+        std::unique_ptr<AbstractHash> table(new DynamicPerfectHash(keys, values, rebuild_threshold));
+        // 切换前先比较查询耗时，不等切换后用一整个慢窗口来发现冻结更慢
+        if (!fasterThan(*table, source, keys))
+            return nullptr;
+        return table;
+    }
+    std::unique_ptr<AbstractHash> table;
+    if (plan.mode == Mode::ELASTIC)
+        table.reset(new ElasticHash(kElasticBucketSize));
+    else
+        table.reset(new SimpleHash(plan.capacity));
+    source.forEach([&](const std::string &key, int value) {
+        table->insert(key, value);
+    });
+    return table;
+}
+
+// 随机抽样一部分键，交替在两个实现上各查询两轮，candidate 总耗时不超过 source 才认为更快。
+// 两者在同一线程上测量，后台构造期间的 CPU 竞争对双方的影响相同
+bool AdaptiveHash::fasterThan(const AbstractHash &candidate, const AbstractHash &source,
+                              const std::vector<std::string> &keys) {
+    std::vector<std::string> sample;
+    size_t stride = std::max<size_t>(1, keys.size() / kProbeSampleSize);
+    for (size_t i = 0; i < keys.size(); i += stride) {
+        sample.push_back(keys[i]);
+    }
+    std::shuffle(sample.begin(), sample.end(), std::mt19937(static_cast<unsigned>(keys.size())));
+    auto time = [&sample](const AbstractHash &table) {
+        int value;
+        auto start = std::chrono::steady_clock::now();
+        for (const auto &key : sample) {
+            table.tryFind(key, value);
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+    double source_time = time(source);
+    double candidate_time = time(candidate);
+    candidate_time += time(candidate);
+    source_time += time(source);
+    return candidate_time <= source_time;
+}
@@ -0,0 +1,103 @@
+#ifndef ADAPTIVE_HASH_HPP
+#define ADAPTIVE_HASH_HPP
+
+#include "abstract_hash.hpp"
+#include <string>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+// AdaptiveHash 对外是普通的 AbstractHash，内部按观测到的负载在几种实现之间切换：
+//   - CHAINED：SimpleHash，读写混合的默认选择；负载因子超过目标值时迁移到更大的容量，
+//     未命中率高时目标负载因子减半（未命中要走完整条链）；
+//   - ELASTIC：ElasticHash，链数组的估计内存超过 memory_limit 时使用，按需分裂、没有空链开销；
+//   - STATIC：DynamicPerfectHash，整个采样窗口内没有写操作时冻结为 MPH 静态层，
+//     写比例重新超过阈值后迁回 CHAINED/ELASTIC。
+//     冻结并不总是更快（MPH 查询要算两次 hash、经过三次相关访存）：MPH 构造失败，
+//     或切换前在后台用抽样键比较发现不比当前实现快，就放弃这次冻结；切换后仍记录
+//     只读窗口的平均耗时，比冻结前慢 10% 以上就迁回。两种情况下直到写操作恢复前都不再冻结。
+// 每 window 次操作评估一次策略。迁移在后台线程中构造新实现，旧实现冻结为只读；
+// 迁移期间的写入记入增量层，查询先查增量层再查旧实现，流量始终不中断。
+// 新实现构造完成后，由调用方线程在下一次操作时回放增量层并替换。
+// 与 SimpleHash 等一样不支持多个线程并发调用（并发场景见 ShardedSimpleHash），
+// 因此查询路径上没有锁：后台线程只读取被冻结的旧实现。
+class AdaptiveHash : public AbstractHash {
+public:
+    enum class Mode { CHAINED, ELASTIC, STATIC };
+
+    // memory_limit 为表结构（不含 key 字节）允许的估计内存，0 表示不限制
+    explicit AdaptiveHash(size_t initial_capacity = 1024, size_t memory_limit = 0, size_t window = 8192);
+    ~AdaptiveHash();
+
+    AdaptiveHash(const AdaptiveHash &) = delete;
+    AdaptiveHash &operator=(const AdaptiveHash &) = delete;
+
+    void insert(const std::string &key, int value) override;
+    void erase(const std::string &key) override;
+    int find(const std::string &key) const override;
+    bool tryFind(const std::string &key, int &value) const override;
+    void forEach(const EntryVisitor &visit) const override;
+
+    // 等待正在进行的迁移完成并切换到新实现
+    void waitForMigration();
+
+    Mode getMode() const { return mode; }
+    size_t size() const { return count; }
+    size_t getMigrationCount() const { return migration_count; }
+    bool isMigrating() const { return migrating; }
+    static const char *modeName(Mode mode);
+
+private:
+    struct DeltaEntry {
+        int value;
+        bool erased;
+    };
+
+    // 迁移目标：模式及 CHAINED 模式下的链数
+    struct Plan {
+        Mode mode;
+        size_t capacity;
+    };
+
+    // 查询也要驱动策略评估（写操作停止后才会冻结）并完成迁移切换，
+    // 因此实现、模式、增量层与采样状态都是 mutable 的
+    mutable std::unique_ptr<AbstractHash> backend;  // 迁移期间只读
+    mutable Mode mode;
+    mutable size_t capacity;                        // CHAINED 模式的链数，其余模式为 0
+    size_t count;
+    mutable bool migrating;
+    mutable std::unordered_map<std::string, DeltaEntry> delta;  // 迁移期间的写入
+    mutable Plan pending_plan;
+    mutable std::unique_ptr<AbstractHash> pending;  // 后台线程构造的新实现
+    mutable std::atomic<bool> pending_ready;
+    mutable std::thread migration_thread;
+    mutable size_t migration_count;
+
+    size_t memory_limit;
+    size_t window;
+    mutable size_t window_ops;
+    mutable size_t window_reads;
+    mutable size_t window_misses;
+    mutable size_t window_writes;
+    mutable std::chrono::steady_clock::time_point window_start;
+    mutable size_t window_start_migrations;
+    mutable double dynamic_read_ns;   // 最近一个动态模式只读窗口的平均耗时
+    mutable bool static_rejected;     // 冻结被证明更慢，写操作恢复前不再冻结
+
+    bool lookup(const std::string &key, int &value) const;
+    void poll() const;
+    void finishMigration() const;
+    void recordOp(bool write) const;
+    void adapt() const;
+    Plan choosePlan(size_t reads, size_t misses, size_t writes, double ns_per_op, bool clean) const;
+    Plan dynamicPlan(size_t reads, size_t misses) const;
+    // 构造 plan 对应的新实现；STATIC 的 MPH 构造失败或抽样查询不比 source 快时返回空
+    static std::unique_ptr<AbstractHash> makeBackend(const Plan &plan, const AbstractHash &source, size_t count);
+    static bool fasterThan(const AbstractHash &candidate, const AbstractHash &source,
+                           const std::vector<std::string> &keys);
+};
+
+#endif // ADAPTIVE_HASH_HPP
@@ -0,0 +1,12 @@
+#include "bloom_filter.hpp"
+#include <algorithm>
+
+BlockedBloomFilter::BlockedBloomFilter(size_t expected_keys, size_t bits_per_key) {
+    size_t bits = std::max<size_t>(expected_keys, 1) * std::max<size_t>(bits_per_key, 1);
+    size_t block_bits = kWordsPerBlock * 32;
+    blocks.assign((bits + block_bits - 1) / block_bits, Block{});
+}
+
+void BlockedBloomFilter::clear() {
+    std::fill(blocks.begin(), blocks.end(), Block{});
+}
@@ -0,0 +1,89 @@
+#ifndef BLOOM_FILTER_HPP
+#define BLOOM_FILTER_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "hash_key.hpp"
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// BlockedBloomFilter 是按块划分的 Bloom filter（split block Bloom filter）：
+//   - 每个块 32 字节 = 8 个 32 位字，按 32 字节对齐，不会跨缓存行；
+//   - 键的 hash 高 32 位选块，低 32 位分别乘 8 个奇数常数取高 5 位，在 8 个字中各置 1 位，
+//     查询只访问一个块；
+//   - 8 路"乘法、移位、生成掩码、与块比较"正好是一组 256 位 SIMD 指令：
+//     编译时启用 AVX2（如 -mavx2）走内建指令，否则走同样结构的标量循环，由编译器向量化。
+// 不支持删除：删除由使用方记录，过时的位过多时整体重建（见 FilteredHash）
+class BlockedBloomFilter {
+public:
+    static constexpr size_t kWordsPerBlock = 8;
+
+    // expected_keys 为设计容量，bits_per_key 为每个键分配的位数，越大误判率越低
+    explicit BlockedBloomFilter(size_t expected_keys = 1024, size_t bits_per_key = 16);
+
+    // 过滤器使用的 hash：对 std::hash 的结果再做一次带种子的混合，
+    // 各位与散列表用 std::hash 选链/选桶的低位不相关
+    static uint64_t hashKey(const std::string &key) {
+        return hashKey(std::hash<std::string>{}(key), key.size());
+    }
+
+    // 调用方已算出 std::hash 时只做混合，同一个整键 hash 可同时交给表使用
+    static uint64_t hashKey(size_t string_hash, size_t size) {
+        return hashWords(string_hash, size, kSeed);
+    }
+
+    void add(uint64_t hash) {
+        Block &block = blocks[blockOf(hash)];
+        uint32_t key = static_cast<uint32_t>(hash);
+        for (size_t i = 0; i < kWordsPerBlock; i++) {
+            block.words[i] |= bitOf(key, i);
+        }
+    }
+
+    // 返回 false 时键一定不在集合中；返回 true 时可能误判
+    bool mayContain(uint64_t hash) const {
+        const Block &block = blocks[blockOf(hash)];
+        uint32_t key = static_cast<uint32_t>(hash);
+#if defined(__AVX2__)
+        __m256i salts = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(kSalts));
+        __m256i shifts = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(key)), salts), 27);
+        __m256i mask = _mm256_sllv_epi32(_mm256_set1_epi32(1), shifts);
+        __m256i words = _mm256_load_si256(reinterpret_cast<const __m256i *>(block.words));
+        return _mm256_testc_si256(words, mask) != 0;  // mask 的每一位在 words 中都已置位
+#else
+        uint32_t missing = 0;
+        for (size_t i = 0; i < kWordsPerBlock; i++) {
+            missing |= bitOf(key, i) & ~block.words[i];
+        }
+        return missing == 0;
+#endif
+    }
+
+    // 批量查询时预取键所在的块
+    const void *blockAddress(uint64_t hash) const { return &blocks[blockOf(hash)]; }
+
+    void clear();
+    size_t getBlockCount() const { return blocks.size(); }
+    size_t getMemoryBytes() const { return blocks.size() * sizeof(Block); }
+
+private:
+    struct alignas(32) Block {
+        uint32_t words[kWordsPerBlock];
+    };
+
+    static constexpr uint64_t kSeed = 0x2545F4914F6CDD1DULL;
+    static constexpr uint32_t kSalts[kWordsPerBlock] = {
+        0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+        0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+    };
+
+    std::vector<Block> blocks;
+
+    static uint32_t bitOf(uint32_t key, size_t i) { return 1u << ((key * kSalts[i]) >> 27); }
+    size_t blockOf(uint64_t hash) const { return static_cast<size_t>(((hash >> 32) * blocks.size()) >> 32); }
+};
+
+#endif // BLOOM_FILTER_HPP
@@ -0,0 +1,298 @@
+#include "cuckoo_hash.hpp"
+#include <cstdint>
+#include <utility>
+
+namespace {
+
+// BFS 最多展开的桶数；4 路分桶时对应长度约 5 的搬移路径
+const size_t kMaxBfsNodes = 512;
+const size_t kNoSlot = SIZE_MAX;
+
+} // namespace
+
+template <class Key>
+BasicCuckooHash<Key>::BasicCuckooHash(size_t capacity) : stash(), count(0), grow_count(0) {
+    size_t buckets = 2;
+    while (buckets * kSlotsPerBucket < capacity) {
+        buckets <<= 1;
+    }
+    bucket_mask = buckets - 1;
+    tags.assign(buckets * kSlotsPerBucket, 0);
+    keys.resize(buckets * kSlotsPerBucket);
+    values.resize(buckets * kSlotsPerBucket);
+}
+
+// tag 取 hash 高 16 位，与选桶用的低位相互独立；0 保留为空槽标记
+template <class Key>
+uint16_t BasicCuckooHash<Key>::tagOf(size_t hash) {
+    uint16_t tag = static_cast<uint16_t>(static_cast<uint64_t>(hash) >> 48);
+    return tag ? tag : 1;
+}
+
+// 异或是对合的：altBucket(altBucket(b, tag), tag) == b，两个候选桶可以互相推出
+template <class Key>
+size_t BasicCuckooHash<Key>::altBucket(size_t bucket, uint16_t tag) const {
+    return (bucket ^ (tag * 0x5BD1E995ULL)) & bucket_mask;
+}
+
+template <class Key>
+size_t BasicCuckooHash<Key>::findSlot(const Key &key, size_t hash) const {
+    uint16_t tag = tagOf(hash);
+    size_t b1 = primaryBucket(hash);
+    size_t b2 = altBucket(b1, tag);
+    prefetchAddress(&tags[b2 * kSlotsPerBucket]);
+    for (size_t bucket : {b1, b2}) {
+        size_t base = bucket * kSlotsPerBucket;
+        for (size_t i = base; i < base + kSlotsPerBucket; i++) {
+            if (tags[i] == tag && keys[i] == key)
+                return i;
+        }
+    }
+    return kNoSlot;
+}
+
+template <class Key>
+size_t BasicCuckooHash<Key>::findStash(const Key &key, size_t hash) const {
+    for (size_t i = 0; i < stash.size(); i++) {
+        if (stash[i].hash == hash && stash[i].key == key)
+            return i;
+    }
+    return kNoSlot;
+}
+
+template <class Key>
+size_t BasicCuckooHash<Key>::freeSlot(size_t bucket) const {
+    size_t base = bucket * kSlotsPerBucket;
+    for (size_t i = base; i < base + kSlotsPerBucket; i++) {
+        if (tags[i] == 0)
+            return i;
+    }
+    return kNoSlot;
+}
+
+// 从两个候选桶出发广度优先搜索，找到一个有空槽的桶后沿路径反向逐个搬移，
+// 最终在候选桶中腾出 slot。搜索期间不修改表；同一路径上不重复经过同一个桶，
+// 保证每次搬移的目标都是该表项的另一个候选桶
+template <class Key>
+bool BasicCuckooHash<Key>::makeRoom(size_t b1, size_t b2, size_t &slot) {
+    struct Node {
+        size_t bucket;
+        size_t parent;  // 父节点下标，根为 kNoSlot
+        size_t from;    // 父桶中将被搬入本桶的槽位
+    };
+    std::vector<Node> queue;
+    queue.reserve(kMaxBfsNodes);
+    queue.push_back({b1, kNoSlot, kNoSlot});
+    if (b2 != b1)
+        queue.push_back({b2, kNoSlot, kNoSlot});
+
+    for (size_t head = 0; head < queue.size(); head++) {
+        size_t bucket = queue[head].bucket;
+        size_t base = bucket * kSlotsPerBucket;
+        for (size_t from = base; from < base + kSlotsPerBucket; from++) {
+            size_t next = altBucket(bucket, tags[from]);
+            bool on_path = false;
+            for (size_t node = head; node != kNoSlot && !on_path; node = queue[node].parent) {
+                on_path = queue[node].bucket == next;
+            }
+            if (on_path)
+                continue;
+
+            size_t dst = freeSlot(next);
+            if (dst != kNoSlot) {
+                size_t src = from;
+                size_t node = head;
+                while (true) {
+                    tags[dst] = tags[src];
+                    keys[dst] = std::move(keys[src]);
+                    values[dst] = values[src];
+                    tags[src] = 0;
+                    dst = src;
+                    if (queue[node].parent == kNoSlot)
+                        break;
+                    src = queue[node].from;
+                    node = queue[node].parent;
+                }
+                slot = dst;
+                return true;
+            }
+            if (queue.size() < kMaxBfsNodes)
+                queue.push_back({next, head, from});
+        }
+    }
+    return false;
+}
+
+// 放入桶中，必要时搬移其他表项；失败时退回 stash，stash 也满时返回 false
+template <class Key>
+bool BasicCuckooHash<Key>::place(const Key &key, int value, size_t hash) {
+    uint16_t tag = tagOf(hash);
+    size_t b1 = primaryBucket(hash);
+    size_t b2 = altBucket(b1, tag);
+    size_t slot = freeSlot(b1);
+    if (slot == kNoSlot)
+        slot = freeSlot(b2);
+    if (slot == kNoSlot && !makeRoom(b1, b2, slot)) {
+        if (stash.size() >= kStashSize)
+            return false;
+        stash.push_back({key, value, hash});
+        return true;
+    }
+    tags[slot] = tag;
+    keys[slot] = key;
+    values[slot] = value;
+    return true;
+}
+
+// 桶数翻倍后重新放入所有表项（包括 stash）；极少数情况下仍放不下则继续翻倍
+template <class Key>
+void BasicCuckooHash<Key>::grow() {
+    std::vector<StashEntry> entries;
+    entries.reserve(count);
+    for (size_t i = 0; i < tags.size(); i++) {
+        if (tags[i] != 0) {
+            size_t hash = KeyTraits<Key>::hash(keys[i]);
+            entries.push_back({std::move(keys[i]), values[i], hash});
+        }
+    }
+    for (auto &entry : stash) {
+        entries.push_back(std::move(entry));
+    }
+
+    size_t slots = tags.size();
+    bool placed = false;
+    while (!placed) {
+        slots *= 2;
+        bucket_mask = slots / kSlotsPerBucket - 1;
+        tags.assign(slots, 0);
+        keys.assign(slots, Key());
+        values.assign(slots, 0);
+        stash.clear();
+        grow_count++;
+        placed = true;
+        for (const auto &entry : entries) {
+            if (!place(entry.key, entry.value, entry.hash)) {
+                placed = false;
+                break;
+            }
+        }
+    }
+}
+
+// 删除腾出空槽后，把能直接放回候选桶的 stash 表项移回去
+template <class Key>
+void BasicCuckooHash<Key>::drainStash() {
+    for (size_t i = 0; i < stash.size();) {
+        uint16_t tag = tagOf(stash[i].hash);
+        size_t b1 = primaryBucket(stash[i].hash);
+        size_t slot = freeSlot(b1);
+        if (slot == kNoSlot)
+            slot = freeSlot(altBucket(b1, tag));
+        if (slot == kNoSlot) {
+            i++;
+            continue;
+        }
+        tags[slot] = tag;
+        keys[slot] = std::move(stash[i].key);
+        values[slot] = stash[i].value;
+        stash[i] = std::move(stash.back());
+        stash.pop_back();
+    }
+}
+
+template <class Key>
+void BasicCuckooHash<Key>::insert(const std::string &key, int value) {
+    if (!KeyTraits<Key>::fits(key))
+        throw std::length_error("Key does not fit in CuckooHash key type");
+    const auto &k = KeyTraits<Key>::from(key);
+    size_t hash = KeyTraits<Key>::hash(k);
+    size_t slot = findSlot(k, hash);
+    if (slot != kNoSlot) {
+        values[slot] = value;
+        return;
+    }
+    size_t stashed = stash.empty() ? kNoSlot : findStash(k, hash);
+    if (stashed != kNoSlot) {
+        stash[stashed].value = value;
+        return;
+    }
+    while (!place(k, value, hash)) {
+        grow();
+    }
+    count++;
+}
+
+template <class Key>
+void BasicCuckooHash<Key>::erase(const std::string &key) {
+    const auto &k = KeyTraits<Key>::from(key);
+    size_t hash = KeyTraits<Key>::hash(k);
+    size_t slot = findSlot(k, hash);
+    if (slot != kNoSlot) {
+        tags[slot] = 0;
+        keys[slot] = Key();
+        count--;
+        if (!stash.empty())
+            drainStash();
+        return;
+    }
+    size_t stashed = stash.empty() ? kNoSlot : findStash(k, hash);
+    if (stashed == kNoSlot)
+        throw std::runtime_error("Key not found in CuckooHash");
+    stash[stashed] = std::move(stash.back());
+    stash.pop_back();
+    count--;
+}
+
+template <class Key>
+int BasicCuckooHash<Key>::find(const std::string &key) const {
+    int value;
+    if (!tryFind(key, value))
+        throw std::runtime_error("Key not found in CuckooHash");
+    return value;
+}
+
+template <class Key>
+bool BasicCuckooHash<Key>::tryFind(const std::string &key, int &value) const {
+    const auto &k = KeyTraits<Key>::from(key);
+    size_t hash = KeyTraits<Key>::hash(k);
+    size_t slot = findSlot(k, hash);
+    if (slot != kNoSlot) {
+        value = values[slot];
+        return true;
+    }
+    if (stash.empty())
+        return false;
+    size_t stashed = findStash(k, hash);
+    if (stashed == kNoSlot)
+        return false;
+    value = stash[stashed].value;
+    return true;
+}
+
+template <class Key>
+void BasicCuckooHash<Key>::forEach(const EntryVisitor &visit) const {
+    for (size_t i = 0; i < tags.size(); i++) {
+        if (tags[i] != 0)
+            visit(KeyTraits<Key>::str(keys[i]), values[i]);
+    }
+    for (const auto &entry : stash) {
+        visit(KeyTraits<Key>::str(entry.key), entry.value);
+    }
+}
+
+template <class Key>
+void BasicCuckooHash<Key>::parallelForEach(const EntryVisitor &visit, unsigned threads) const {
+    forEachRange(tags.size() / kSlotsPerBucket, threads, [this, &visit](size_t begin, size_t end) {
+        for (size_t i = begin * kSlotsPerBucket; i < end * kSlotsPerBucket; i++) {
+            if (tags[i] != 0)
+                visit(KeyTraits<Key>::str(keys[i]), values[i]);
+        }
+    });
+    for (const auto &entry : stash) {
+        visit(KeyTraits<Key>::str(entry.key), entry.value);
+    }
+}
+
+template class BasicCuckooHash<std::string>;
+template class BasicCuckooHash<InlineKey<8>>;
+template class BasicCuckooHash<InlineKey<16>>;
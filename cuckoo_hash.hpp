@@ -0,0 +1,79 @@
+#ifndef CUCKOO_HASH_HPP
+#define CUCKOO_HASH_HPP
+
+#include "abstract_hash.hpp"
+#include "hash_key.hpp"
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+// BasicCuckooHash 是 4 路分桶的布谷鸟散列（partial-key cuckoo hashing）：
+//   - 每个 key 有两个候选桶：b1 取 hash 低位，b2 = b1 ^ f(tag)，tag 为 hash 高 16 位。
+//     备选桶只依赖 tag，搬移表项时不必重新计算 key 的 hash；
+//   - 每个桶 4 个槽位，tag 单独存放在紧凑数组中（一个桶 8 字节），
+//     查找最多检查两个桶的 tag 再比较命中的 key，外加一个很小的溢出区（stash）；
+//   - 插入时两个候选桶都满，则从这两个桶出发广度优先搜索最短的搬移路径，
+//     找不到（或路径过长）时放入 stash，stash 也满才整体扩容一倍。
+// 4 路分桶加 BFS 插入可以把装载率做到 95% 以上，查找的最坏情况仍是固定的两个桶加 stash。
+// Key 为 std::string 或短 key 特化 InlineKey<8>/InlineKey<16>
+template <class Key>
+class BasicCuckooHash : public AbstractHash {
+public:
+    static constexpr size_t kSlotsPerBucket = 4;
+    static constexpr size_t kStashSize = 8;
+
+    // capacity 为预期的表项数，向上取整为 2 的幂个桶
+    BasicCuckooHash(size_t capacity = 1024);
+
+    void insert(const std::string &key, int value) override;
+    void erase(const std::string &key) override;
+    int find(const std::string &key) const override;
+    bool tryFind(const std::string &key, int &value) const override;
+    void forEach(const EntryVisitor &visit) const override;
+    // 按桶下标切分区间，stash 在所有线程结束后由调用线程遍历
+    void parallelForEach(const EntryVisitor &visit, unsigned threads = 0) const override;
+
+    size_t size() const { return count; }
+    size_t getSlotCount() const { return tags.size(); }
+    size_t getStashSize() const { return stash.size(); }
+    size_t getGrowCount() const { return grow_count; }
+    double getLoadFactor() const { return static_cast<double>(count) / tags.size(); }
+
+private:
+    struct StashEntry {
+        Key key;
+        int value;
+        size_t hash;
+    };
+
+    size_t bucket_mask;
+    std::vector<uint16_t> tags;   // 0 表示空槽
+    std::vector<Key> keys;
+    std::vector<int> values;
+    std::vector<StashEntry> stash;
+    size_t count;
+    size_t grow_count;
+
+    static uint16_t tagOf(size_t hash);
+    size_t primaryBucket(size_t hash) const { return hash & bucket_mask; }
+    size_t altBucket(size_t bucket, uint16_t tag) const;
+
+    // 返回 key 所在的槽位下标，不在桶中时返回 SIZE_MAX（可能在 stash 中）
+    size_t findSlot(const Key &key, size_t hash) const;
+    size_t findStash(const Key &key, size_t hash) const;
+    size_t freeSlot(size_t bucket) const;
+    bool place(const Key &key, int value, size_t hash);
+    bool makeRoom(size_t b1, size_t b2, size_t &slot);
+    void grow();
+    void drainStash();
+};
+
+using CuckooHash = BasicCuckooHash<std::string>;
+
+// 实现位于 cuckoo_hash.cpp，仅显式实例化以下 key 类型
+extern template class BasicCuckooHash<std::string>;
+extern template class BasicCuckooHash<InlineKey<8>>;
+extern template class BasicCuckooHash<InlineKey<16>>;
+
+#endif // CUCKOO_HASH_HPP
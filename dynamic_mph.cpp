@@ -0,0 +1,252 @@
+#include "dynamic_mph.hpp"
+#include <algorithm>
+#include <unordered_set>
+#include <string_view>
+
+DynamicPerfectHash::StaticSet::StaticSet(std::vector<std::string> input_keys, std::vector<int> input_values) {
+    if (input_keys.empty())
+        return;
+    // 键集移交给 MPH 保存，不另存一份；MPH 下标即键在输入中的位置，values 无需重排。
+    // 退化为线性查找的结果不能作为静态层，构造失败直接抛出
+    mph.reset(new MinimalPerfectHash(std::move(input_keys), false));
+    values = std::move(input_values);
+}
+
+const int *DynamicPerfectHash::StaticSet::lookup(const std::string &key) const {
+    if (!mph)
+        return nullptr;
+    int slot = mph->hash(key);
+    if (mph->keyAt(slot) != key)
+        return nullptr;
+    return &values[slot];
+}
+
+DynamicPerfectHash::DynamicPerfectHash(const std::vector<std::string> &keys,
+                                       const std::vector<int> &values,
+                                       size_t rebuild_threshold)
+    : rebuilding(false), rebuild_failed(false), rebuild_threshold(rebuild_threshold) {
+    std::vector<int> initial_values = values;
+    if (initial_values.empty()) {
+        for (size_t i = 0; i < keys.size(); i++) {
+            initial_values.push_back(static_cast<int>(i));
+        }
+    }
+    if (initial_values.size() != keys.size())
+        throw std::invalid_argument("DynamicPerfectHash needs one value per key");
+    // 重复键会让 MPH 的每次构造尝试都失败，提前给出明确的错误
+    std::unordered_set<std::string_view> seen;
+    seen.reserve(keys.size());
+    for (const auto &key : keys) {
+        if (!seen.insert(key).second)
+            throw std::invalid_argument("Duplicate key in DynamicPerfectHash initial set: " + key);
+    }
+    auto base = std::make_shared<const StaticSet>(keys, initial_values);
+    state = std::make_shared<const State>(State{base, nullptr});
+}
+
+DynamicPerfectHash::~DynamicPerfectHash() {
+    std::lock_guard<std::mutex> guard(rebuild_lock);
+    if (rebuild_thread.joinable())
+        rebuild_thread.join();
+}
+
+int DynamicPerfectHash::lookupState(const State &view, const std::string &key, bool &found) {
+    if (view.frozen) {
+        auto it = view.frozen->find(key);
+        if (it != view.frozen->end()) {
+            found = !it->second.erased;
+            return it->second.value;
+        }
+    }
+    const int *value = view.base->lookup(key);
+    found = value != nullptr;
+    return found ? *value : 0;
+}
+
+// 必须先查活跃增量层再读取 state：重建启动时在 delta_lock 下先发布冻结层再清空增量层，
+// 因此没在活跃层找到的键一定能在随后读到的 state 中找到
+int DynamicPerfectHash::lookup(const std::string &key, bool &found) const {
+    {
+        std::shared_lock<std::shared_mutex> guard(delta_lock);
+        auto it = delta.find(key);
+        if (it != delta.end()) {
+            found = !it->second.erased;
+            return it->second.value;
+        }
+    }
+    std::shared_ptr<const State> view = std::atomic_load(&state);
+    return lookupState(*view, key, found);
+}
+
+void DynamicPerfectHash::forEach(const EntryVisitor &visit) const {
+    std::shared_lock<std::shared_mutex> guard(delta_lock);
+    std::shared_ptr<const State> view = std::atomic_load(&state);
+    for (const auto &item : delta) {
+        if (!item.second.erased)
+            visit(item.first, item.second.value);
+    }
+    if (view->frozen) {
+        for (const auto &item : *view->frozen) {
+            if (!item.second.erased && delta.count(item.first) == 0)
+                visit(item.first, item.second.value);
+        }
+    }
+    const StaticSet &base = *view->base;
+    for (size_t i = 0; i < base.size(); i++) {
+        const std::string &key = base.key(i);
+        if (delta.count(key) == 0 && (!view->frozen || view->frozen->count(key) == 0))
+            visit(key, base.values[i]);
+    }
+}
+
+void DynamicPerfectHash::insert(const std::string &key, int value) {
+    bool full;
+    {
+        std::unique_lock<std::shared_mutex> guard(delta_lock);
+        delta[key] = DeltaEntry{value, false};
+        full = delta.size() >= rebuild_threshold;
+    }
+    if (full)
+        startRebuild();
+}
+
+void DynamicPerfectHash::erase(const std::string &key) {
+    bool full;
+    {
+        std::unique_lock<std::shared_mutex> guard(delta_lock);
+        auto it = delta.find(key);
+        if (it != delta.end()) {
+            if (it->second.erased)
+                throw std::runtime_error("Key not found in DynamicPerfectHash");
+            it->second.erased = true;
+        } else {
+            bool found;
+            lookupState(*std::atomic_load(&state), key, found);
+            if (!found)
+                throw std::runtime_error("Key not found in DynamicPerfectHash");
+            delta[key] = DeltaEntry{0, true};
+        }
+        full = delta.size() >= rebuild_threshold;
+    }
+    if (full)
+        startRebuild();
+}
+
+int DynamicPerfectHash::find(const std::string &key) const {
+    bool found;
+    int value = lookup(key, found);
+    if (!found)
+        throw std::runtime_error("Key not found in DynamicPerfectHash");
+    return value;
+}
+
+bool DynamicPerfectHash::tryFind(const std::string &key, int &value) const {
+    bool found;
+    int result = lookup(key, found);
+    if (found)
+        value = result;
+    return found;
+}
+
+bool DynamicPerfectHash::contains(const std::string &key) const {
+    bool found;
+    lookup(key, found);
+    return found;
+}
+
+// 写路径上用 try_lock 触发重建：已有重建在进行或正在被回收时直接跳过，写操作不会等待
+bool DynamicPerfectHash::startRebuild() {
+    std::unique_lock<std::mutex> guard(rebuild_lock, std::try_to_lock);
+    if (!guard.owns_lock() || rebuilding.load())
+        return false;
+    if (rebuild_thread.joinable())
+        rebuild_thread.join();
+    
+    std::shared_ptr<const State> captured;
+    {
+        std::unique_lock<std::shared_mutex> delta_guard(delta_lock);
+        if (delta.empty())
+            return false;
+        auto frozen = std::make_shared<const DeltaMap>(std::move(delta));
+        delta = DeltaMap();
+        captured = std::make_shared<const State>(State{std::atomic_load(&state)->base, frozen});
+        std::atomic_store(&state, captured);
+    }
+    rebuilding.store(true);
+    rebuild_thread = std::thread(&DynamicPerfectHash::runRebuild, this, captured);
+    return true;
+}
+
+// 后台线程：合并冻结增量层与静态层并重新构造 MPH，全程不持有任何查询路径上的锁
+void DynamicPerfectHash::runRebuild(std::shared_ptr<const State> captured) {
+    std::vector<std::string> keys;
+    std::vector<int> values;
+    const StaticSet &base = *captured->base;
+    for (size_t i = 0; i < base.size(); i++) {
+        if (captured->frozen->count(base.key(i)) == 0) {
+            keys.push_back(base.key(i));
+            values.push_back(base.values[i]);
+        }
+    }
+    for (const auto &item : *captured->frozen) {
+        if (!item.second.erased) {
+            keys.push_back(item.first);
+            values.push_back(item.second.value);
+        }
+    }
+    std::shared_ptr<const StaticSet> rebuilt;
+    try {
+        rebuilt = std::make_shared<const StaticSet>(std::move(keys), std::move(values));
+    } catch (const std::runtime_error &) {
+        // 构造失败：冻结层复制回活跃增量层（活跃层中更新的写入优先），下次重建时一起冻结；
+        // state 保持 {旧静态层, 冻结层} 不变，没在活跃层找到键的查询仍能在冻结层找到，
+        // 冻结层直到下次 startRebuild 才被替换。
+        // 阈值翻倍，避免每次写入都立即触发又一次失败的重建
+        {
+            std::unique_lock<std::shared_mutex> guard(delta_lock);
+            for (const auto &item : *captured->frozen) {
+                delta.emplace(item.first, item.second);
+            }
+            rebuild_threshold = std::max(rebuild_threshold, delta.size()) * 2;
+        }
+        rebuild_failed.store(true);
+        rebuilding.store(false);
+        return;
+    }
+    // 重建期间只有本线程会替换 state，直接发布新的静态层
+    std::atomic_store(&state, std::make_shared<const State>(State{rebuilt, nullptr}));
+    rebuild_failed.store(false);
+    rebuilding.store(false);
+}
+
+void DynamicPerfectHash::rebuild() {
+    std::unique_lock<std::mutex> guard(rebuild_lock);
+    if (rebuild_thread.joinable())
+        rebuild_thread.join();
+    guard.unlock();
+    
+    // 其他写线程可能抢先启动了重建，等待它结束后再合并剩余的增量
+    while (getDeltaSize() > 0 || rebuilding.load()) {
+        if (!startRebuild()) {
+            guard.lock();
+            if (rebuild_thread.joinable())
+                rebuild_thread.join();
+            guard.unlock();
+            continue;
+        }
+        guard.lock();
+        rebuild_thread.join();
+        guard.unlock();
+        if (rebuild_failed.load())
+            throw std::runtime_error("DynamicPerfectHash rebuild failed to construct an MPH");
+    }
+}
+
+size_t DynamicPerfectHash::getDeltaSize() const {
+    std::shared_lock<std::shared_mutex> guard(delta_lock);
+    return delta.size();
+}
+
+size_t DynamicPerfectHash::getStaticSize() const {
+    return std::atomic_load(&state)->base->size();
+}
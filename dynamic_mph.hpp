@@ -0,0 +1,94 @@
+#ifndef DYNAMIC_MPH_HPP
+#define DYNAMIC_MPH_HPP
+
+#include "abstract_hash.hpp"
+#include "mph.hpp"
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <shared_mutex>
+#include <mutex>
+#include <thread>
+#include <atomic>
+
+// DynamicPerfectHash 在只能一次性构造的 MinimalPerfectHash 之上支持增删：
+//   - 静态层：MPH + 按 hash 下标存放的 key/value 数组，只读；
+//   - 增量层：记录新插入/更新的键和删除墓碑，查询时优先访问。
+// 增量层超过阈值后在后台线程中合并两层、重新构造 MPH，完成后原子替换静态层。
+// 查询只在增量层上持有短暂的读锁，不会因后台重建或替换而阻塞。
+class DynamicPerfectHash : public AbstractHash {
+public:
+    // values 为空时每个键的值取其在 keys 中的下标；keys 含重复键时抛出 std::invalid_argument
+    explicit DynamicPerfectHash(const std::vector<std::string> &keys = {},
+                                const std::vector<int> &values = {},
+                                size_t rebuild_threshold = 4096);
+    ~DynamicPerfectHash();
+    
+    DynamicPerfectHash(const DynamicPerfectHash &) = delete;
+    DynamicPerfectHash &operator=(const DynamicPerfectHash &) = delete;
+    
+    void insert(const std::string &key, int value) override;
+    void erase(const std::string &key) override;
+    int find(const std::string &key) const override;
+    bool contains(const std::string &key) const override;
+    bool tryFind(const std::string &key, int &value) const override;
+    
+    // 依次遍历活跃增量层、冻结增量层和静态层，跳过被上层覆盖或删除的键；
+    // 遍历期间持有增量层读锁，写操作会等待遍历结束
+    void forEach(const EntryVisitor &visit) const override;
+    
+    // 把当前增量层合并进静态层，并等待重建完成；MPH 构造失败时抛出异常，数据仍在增量层中
+    void rebuild();
+    
+    size_t getDeltaSize() const;
+    size_t getStaticSize() const;
+    bool isRebuilding() const { return rebuilding.load(); }
+    // 最近一次后台重建是否因 MPH 构造失败而放弃
+    bool lastRebuildFailed() const { return rebuild_failed.load(); }
+    
+private:
+    struct DeltaEntry {
+        int value;
+        bool erased;
+    };
+    using DeltaMap = std::unordered_map<std::string, DeltaEntry>;
+    
+    // 不可变的静态层：键只保存在 MPH 中（第 i 个键的 hash 为 i），
+    // mph->keyAt(mph->hash(k)) == k 时命中，值为 values[mph->hash(k)]
+    struct StaticSet {
+        std::unique_ptr<MinimalPerfectHash> mph;
+        std::vector<int> values;
+        
+        StaticSet(std::vector<std::string> keys, std::vector<int> values);
+        const int *lookup(const std::string &key) const;
+        size_t size() const { return values.size(); }
+        const std::string &key(size_t i) const { return mph->keyAt(i); }
+    };
+    
+    // 查询看到的只读视图：重建期间被冻结的增量层 + 静态层，整体原子替换
+    struct State {
+        std::shared_ptr<const StaticSet> base;
+        std::shared_ptr<const DeltaMap> frozen;
+    };
+    
+    std::shared_ptr<const State> state;  // 仅通过 std::atomic_load/atomic_store 访问
+    
+    mutable std::shared_mutex delta_lock;
+    DeltaMap delta;                       // 活跃增量层
+    
+    std::mutex rebuild_lock;              // 保护 rebuild_thread 的启动与回收
+    std::thread rebuild_thread;
+    std::atomic<bool> rebuilding;
+    std::atomic<bool> rebuild_failed;
+    size_t rebuild_threshold;             // 受 delta_lock 保护，重建失败后翻倍
+    
+    // 依次查询活跃增量层、冻结增量层、静态层；found 为 false 表示不存在或已删除
+    int lookup(const std::string &key, bool &found) const;
+    static int lookupState(const State &view, const std::string &key, bool &found);
+    
+    bool startRebuild();
+    void runRebuild(std::shared_ptr<const State> captured);
+};
+
+#endif // DYNAMIC_MPH_HPP
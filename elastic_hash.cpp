@@ -1,104 +1,333 @@
 #include "elastic_hash.hpp"
 #include <functional>
+#include <iterator>
+#include <algorithm>
 
-ElasticHash::ElasticHash(int bucket_size)
-    : bucket_size(bucket_size), global_depth(1) {
+template <class Key>
+BasicElasticHash<Key>::BasicElasticHash(int bucket_size)
+    : bucket_size(bucket_size), merge_threshold(bucket_size / 2), global_depth(1) {
     directory.resize(1 << global_depth, nullptr);
+    depth_count.assign(global_depth + 1, 0);
     for (int i = 0; i < (1 << global_depth); i++) {
-        directory[i] = new Bucket{global_depth, {}};
+        directory[i] = newBucket(global_depth);
+        depth_count[global_depth]++;
     }
 }
 
-int ElasticHash::hashKey(const std::string &key) const {
-    std::hash<std::string> hasher;
-    return static_cast<int>(hasher(key));
+template <class Key>
+BasicElasticHash<Key>::~BasicElasticHash() {
+    // 多个目录项可能指向同一个桶，按桶列表释放，每个桶恰好一次
+    for (Bucket* bucket : buckets) {
+        delete bucket;
+    }
+}
+
+template <class Key>
+typename BasicElasticHash<Key>::Bucket* BasicElasticHash<Key>::newBucket(int local_depth) {
+    Bucket* bucket = new Bucket{local_depth, {}, buckets.size()};
+    buckets.push_back(bucket);
+    return bucket;
+}
+
+// 与列表末尾的桶交换后弹出，O(1) 删除
+template <class Key>
+void BasicElasticHash<Key>::deleteBucket(Bucket* bucket) {
+    Bucket* last = buckets.back();
+    buckets[bucket->list_index] = last;
+    last->list_index = bucket->list_index;
+    buckets.pop_back();
+    delete bucket;
 }
 
-Bucket* ElasticHash::getBucket(int index) const {
+template <class Key>
+size_t BasicElasticHash<Key>::hashKey(const Key &key) const {
+    return KeyTraits<Key>::hash(key);
+}
+
+template <class Key>
+typename BasicElasticHash<Key>::Bucket* BasicElasticHash<Key>::getBucket(int index) const {
     return directory[index];
 }
 
-void ElasticHash::doubleDirectory() {
+template <class Key>
+void BasicElasticHash<Key>::doubleDirectory() {
     int old_size = directory.size();
     global_depth++;
     directory.resize(1 << global_depth);
+    depth_count.resize(global_depth + 1, 0);
     for (int i = 0; i < old_size; i++) {
         directory[i + old_size] = directory[i];
     }
 }
 
-void ElasticHash::splitBucket(int index) {
+template <class Key>
+void BasicElasticHash<Key>::splitBucket(int index) {
     Bucket* bucket = getBucket(index);
     int local_depth = bucket->local_depth;
     if (local_depth == global_depth) {
         doubleDirectory();
     }
-    Bucket* newBucket = new Bucket{local_depth + 1, {}};
+    Bucket* sibling = newBucket(local_depth + 1);
     bucket->local_depth++;
+    depth_count[local_depth]--;
+    depth_count[local_depth + 1] += 2;
     
-    // 重新分配当前 bucket 中项
-    std::vector<std::pair<std::string, int>> temp = bucket->entries;
-    bucket->entries.clear();
+    // 重新分配当前 bucket 中项：直接使用缓存的 hash，不再重新计算
+    std::vector<Entry> temp;
+    temp.swap(bucket->entries);
     int mask = (1 << bucket->local_depth) - 1;
     for (auto &entry : temp) {
-        int hash_val = hashKey(entry.first);
-        int dir_index = hash_val & mask;
+        int dir_index = static_cast<int>(entry.hashValue() & mask);
         if ((dir_index & (1 << (bucket->local_depth - 1))) != 0)
-            newBucket->entries.push_back(entry);
+            sibling->entries.push_back(std::move(entry));
         else
-            bucket->entries.push_back(entry);
+            bucket->entries.push_back(std::move(entry));
     }
-    // 更新目录中指向 bucket 的指针
+    // 更新目录中指向 bucket 且新增位为 1 的指针，只需按步长遍历这些槽位
     int dir_size = directory.size();
-    for (int i = 0; i < dir_size; i++) {
-        int idx_mask = i & mask;
-        if (directory[i] == bucket) {
-            if ((idx_mask & (1 << (bucket->local_depth - 1))) != 0)
-                directory[i] = newBucket;
+    int high_bit = 1 << local_depth;
+    for (int i = (index & (high_bit - 1)) | high_bit; i < dir_size; i += high_bit << 1) {
+        directory[i] = sibling;
+    }
+}
+
+// 与伙伴桶合并：合并后的容量阈值为 bucket_size / 2，
+// 与分裂阈值 bucket_size 之间留出滞后区间，避免反复分裂/合并
+template <class Key>
+void BasicElasticHash<Key>::mergeBucket(int index) {
+    bool merged = false;
+    Bucket* bucket = getBucket(index);
+    while (bucket->local_depth > 1) {
+        int high_bit = 1 << (bucket->local_depth - 1);
+        Bucket* buddy = getBucket(index ^ high_bit);
+        if (buddy == bucket || buddy->local_depth != bucket->local_depth)
+            break;
+        if (bucket->entries.size() + buddy->entries.size() > (unsigned)merge_threshold)
+            break;
+        
+        // 保留高位为 0 的一侧，使桶在目录中的首个引用位置不变
+        Bucket* keep = (index & high_bit) ? buddy : bucket;
+        Bucket* drop = (keep == bucket) ? buddy : bucket;
+        keep->entries.insert(keep->entries.end(),
+                             std::make_move_iterator(drop->entries.begin()),
+                             std::make_move_iterator(drop->entries.end()));
+        depth_count[keep->local_depth] -= 2;
+        keep->local_depth--;
+        depth_count[keep->local_depth]++;
+        int dir_size = directory.size();
+        for (int i = (index & (high_bit - 1)); i < dir_size; i += high_bit) {
+            directory[i] = keep;
         }
+        deleteBucket(drop);
+        bucket = keep;
+        index &= high_bit - 1;
+        merged = true;
     }
+    if (merged)
+        shrinkDirectory();
 }
 
-void ElasticHash::insert(const std::string &key, int value) {
-    int hash_val = hashKey(key);
-    int dir_index = hash_val & ((1 << global_depth) - 1);
+// 当所有桶的局部深度都小于全局深度时，目录的上半部分只是下半部分的镜像，可以减半
+template <class Key>
+void BasicElasticHash<Key>::shrinkDirectory() {
+    while (global_depth > 1 && depth_count[global_depth] == 0) {
+        global_depth--;
+        directory.resize(1 << global_depth);
+        directory.shrink_to_fit();
+        depth_count.resize(global_depth + 1);
+    }
+}
+
+template <class Key>
+void BasicElasticHash<Key>::insert(const std::string &key, int value) {
+    if (!KeyTraits<Key>::fits(key))
+        throw std::length_error("Key does not fit in ElasticHash key type");
+    const auto &k = KeyTraits<Key>::from(key);
+    size_t hash_val = hashKey(k);
+    int dir_index = static_cast<int>(hash_val & ((1 << global_depth) - 1));
     Bucket* bucket = getBucket(dir_index);
     // 如果 key 存在则更新
     for (auto &entry : bucket->entries) {
-        if (entry.first == key) {
-            entry.second = value;
+        if (entry.matches(hash_val, k)) {
+            entry.value = value;
             return;
         }
     }
-    if (bucket->entries.size() >= (unsigned)bucket_size) {
+    // 桶满则分裂，直到目标桶有空位；key 的 hash 只计算一次
+    while (bucket->entries.size() >= (unsigned)bucket_size) {
         splitBucket(dir_index);
-        insert(key, value);
-        return;
+        dir_index = static_cast<int>(hash_val & ((1 << global_depth) - 1));
+        bucket = getBucket(dir_index);
     }
-    bucket->entries.push_back({key, value});
+    bucket->entries.push_back({k, value, hash_val});
 }
 
-void ElasticHash::erase(const std::string &key) {
-    int hash_val = hashKey(key);
-    int dir_index = hash_val & ((1 << global_depth) - 1);
+template <class Key>
+void BasicElasticHash<Key>::erase(const std::string &key) {
+    const auto &k = KeyTraits<Key>::from(key);
+    size_t hash_val = hashKey(k);
+    int dir_index = static_cast<int>(hash_val & ((1 << global_depth) - 1));
     Bucket* bucket = getBucket(dir_index);
     for (auto it = bucket->entries.begin(); it != bucket->entries.end(); ++it) {
-        if (it->first == key) {
+        if (it->matches(hash_val, k)) {
             bucket->entries.erase(it);
+            mergeBucket(dir_index);
             return;
         }
     }
     throw std::runtime_error("Key not found in ElasticHash");
 }
 
-int ElasticHash::find(const std::string &key) const {
-    int hash_val = hashKey(key);
-    int dir_index = hash_val & ((1 << global_depth) - 1);
+template <class Key>
+int BasicElasticHash<Key>::find(const std::string &key) const {
+    int value;
+    if (!tryFind(key, value))
+        throw std::runtime_error("Key not found in ElasticHash");
+    return value;
+}
+
+template <class Key>
+bool BasicElasticHash<Key>::tryFind(const std::string &key, int &value) const {
+    const auto &k = KeyTraits<Key>::from(key);
+    return tryFindHashed(key, hashKey(k), value);
+}
+
+template <class Key>
+bool BasicElasticHash<Key>::tryFindHashed(const std::string &key, size_t string_hash, int &value) const {
+    const auto &k = KeyTraits<Key>::from(key);
+    size_t hash_val = KeyTraits<Key>::hash(k, string_hash);
+    int dir_index = static_cast<int>(hash_val & ((1 << global_depth) - 1));
     Bucket* bucket = getBucket(dir_index);
     for (auto &entry : bucket->entries) {
-        if (entry.first == key) {
-            return entry.second;
+        if (entry.matches(hash_val, k)) {
+            value = entry.value;
+            return true;
         }
     }
-    throw std::runtime_error("Key not found in ElasticHash");
+    return false;
 }
+
+template <class Key>
+size_t BasicElasticHash<Key>::findBatch(const std::string *keys, size_t count, int *values, bool *found,
+                                        size_t group_size) const {
+    return findBatchLoop([keys](size_t i) -> const std::string & { return keys[i]; }, nullptr,
+                         count, values, found, group_size);
+}
+
+template <class Key>
+size_t BasicElasticHash<Key>::findBatchHashed(const std::string *const *keys, const size_t *string_hashes, size_t count,
+                                              int *values, bool *found, size_t group_size) const {
+    return findBatchLoop([keys](size_t i) -> const std::string & { return *keys[i]; }, string_hashes,
+                         count, values, found, group_size);
+}
+
+// string_hashes may be null, in which case each key is hashed in the HASH stage
+template <class Key>
+template <class KeyAt>
+size_t BasicElasticHash<Key>::findBatchLoop(KeyAt key_at, const size_t *string_hashes, size_t count,
+                                            int *values, bool *found, size_t group_size) const {
+    enum Stage { HASH, DIRECTORY, BUCKET, SCAN, COMPARE, IDLE };
+    struct Slot {
+        size_t index;
+        size_t hash;
+        const Bucket *bucket;
+        const Entry *pos;
+        const Entry *end;
+        Stage stage;
+    };
+    
+    if (group_size == 0)
+        group_size = 1;
+    std::vector<Slot> slots(std::min(group_size, count));
+    size_t next = 0, hits = 0, active = slots.size();
+    for (auto &slot : slots) {
+        slot.index = next++;
+        slot.stage = HASH;
+    }
+    
+    size_t mask = (static_cast<size_t>(1) << global_depth) - 1;
+    while (active > 0) {
+        for (auto &slot : slots) {
+            const Entry *hit = nullptr;
+            switch (slot.stage) {
+            case HASH:
+                if (string_hashes)
+                    slot.hash = KeyTraits<Key>::hash(KeyTraits<Key>::from(key_at(slot.index)), string_hashes[slot.index]);
+                else
+                    slot.hash = hashKey(KeyTraits<Key>::from(key_at(slot.index)));
+                prefetchAddress(&directory[slot.hash & mask]);
+                slot.stage = DIRECTORY;
+                continue;
+            case DIRECTORY:
+                slot.bucket = directory[slot.hash & mask];
+                prefetchAddress(slot.bucket);
+                slot.stage = BUCKET;
+                continue;
+            case BUCKET:
+                slot.pos = slot.bucket->entries.data();
+                slot.end = slot.pos + slot.bucket->entries.size();
+                prefetchAddress(slot.pos);
+                slot.stage = SCAN;
+                continue;
+            case SCAN:
+                while (slot.pos != slot.end && !slot.pos->hashMatches(slot.hash))
+                    ++slot.pos;
+                if (slot.pos != slot.end) {
+                    prefetchAddress(KeyTraits<Key>::address(slot.pos->key));
+                    slot.stage = COMPARE;
+                    continue;
+                }
+                break;
+            case COMPARE:
+                if (slot.pos->key == KeyTraits<Key>::from(key_at(slot.index))) {
+                    hit = slot.pos;
+                    break;
+                }
+                ++slot.pos;
+                slot.stage = SCAN;
+                continue;
+            case IDLE:
+                continue;
+            }
+            
+            // Lookup finished: store the result and start the next key in this slot
+            found[slot.index] = hit != nullptr;
+            if (hit) {
+                values[slot.index] = hit->value;
+                hits++;
+            }
+            if (next < count) {
+                slot.index = next++;
+                slot.stage = HASH;
+            } else {
+                slot.stage = IDLE;
+                active--;
+            }
+        }
+    }
+    return hits;
+}
+
+template <class Key>
+void BasicElasticHash<Key>::forEach(const EntryVisitor &visit) const {
+    for (const auto &entry : *this) {
+        visit(KeyTraits<Key>::str(entry.key), entry.value);
+    }
+}
+
+template <class Key>
+void BasicElasticHash<Key>::parallelForEach(const EntryVisitor &visit, unsigned threads) const {
+    // 按桶列表均分：每个桶恰好出现一次且至多 bucket_size 个表项，各线程的工作量接近；
+    // 不经过目录，目录远大于桶数时也不需要先扫描一遍
+    forEachRange(buckets.size(), threads, [this, &visit](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            for (const auto &entry : buckets[i]->entries) {
+                visit(KeyTraits<Key>::str(entry.key), entry.value);
+            }
+        }
+    });
+}
+
+template class BasicElasticHash<std::string>;
+template class BasicElasticHash<InlineKey<8>>;
+template class BasicElasticHash<InlineKey<16>>;
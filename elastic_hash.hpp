@@ -2,33 +2,129 @@
 #define ELASTIC_HASH_HPP
 
 #include "abstract_hash.hpp"
+#include "hash_key.hpp"
 #include <string>
 #include <vector>
 #include <stdexcept>
 #include <functional>
+#include <iterator>
 
-struct Bucket {
+template <class Key>
+struct BasicBucket {
     int local_depth; // The depth of the bucket in the directory
-    std::vector<std::pair<std::string, int>> entries; // Key-value pairs stored in the bucket
+    std::vector<BasicHashEntry<Key>> entries; // Key-value pairs (with cached hash) stored in the bucket
+    size_t list_index; // Position of the bucket in the table's bucket list
 };
 
-class ElasticHash : public AbstractHash {
+// Key is std::string or one of the short-key specializations InlineKey<8>/InlineKey<16>
+template <class Key>
+class BasicElasticHash : public AbstractHash {
 public:
-    ElasticHash(int bucket_size = 4); // Constructor to initialize the hash table with a given bucket size
+    using Entry = BasicHashEntry<Key>;
+    using Bucket = BasicBucket<Key>;
+    
+    BasicElasticHash(int bucket_size = 4); // Constructor to initialize the hash table with a given bucket size
+    ~BasicElasticHash();
+    
+    BasicElasticHash(const BasicElasticHash &) = delete;
+    BasicElasticHash &operator=(const BasicElasticHash &) = delete;
     
     void insert(const std::string &key, int value) override; // Add a key-value pair to the hash table
     void erase(const std::string &key) override; // Delete a key from the hash table
     int find(const std::string &key) const override; // Find the value associated with a key
+    bool tryFind(const std::string &key, int &value) const override; // Same as find, but reports a miss without throwing
+    // Batched AMAC lookup: interleaves group_size lookups, prefetching each hop
+    // (directory slot -> bucket -> entries -> key bytes) before switching to the next lookup
+    size_t findBatch(const std::string *keys, size_t count, int *values, bool *found,
+                     size_t group_size = 8) const override;
+    // Lookups that reuse the caller's std::hash of the key (ignored for InlineKey tables)
+    bool tryFindHashed(const std::string &key, size_t string_hash, int &value) const override;
+    size_t findBatchHashed(const std::string *const *keys, const size_t *string_hashes, size_t count,
+                           int *values, bool *found, size_t group_size = 8) const override;
+    
+    // 目录与桶的统计信息，用于观察删除后的收缩效果
+    int getGlobalDepth() const { return global_depth; }
+    size_t getDirectorySize() const { return directory.size(); }
+    size_t getBucketCount() const { return buckets.size(); }
+    
+    // Forward iterator over all entries. Walks the bucket list rather than the directory
+    // (where several slots alias one bucket), so every entry is seen exactly once and the
+    // cost is proportional to the number of buckets. Invalidated by insert/erase.
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Entry;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Entry *;
+        using reference = const Entry &;
+        
+        const_iterator() : buckets(nullptr), bucket(0), pos(0) {}
+        const_iterator(const std::vector<Bucket*> *buckets, size_t bucket)
+            : buckets(buckets), bucket(bucket), pos(0) { skipEmpty(); }
+        
+        reference operator*() const { return (*buckets)[bucket]->entries[pos]; }
+        pointer operator->() const { return &(*buckets)[bucket]->entries[pos]; }
+        const_iterator &operator++() {
+            ++pos;
+            skipEmpty();
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator old = *this;
+            ++*this;
+            return old;
+        }
+        bool operator==(const const_iterator &other) const { return bucket == other.bucket && pos == other.pos; }
+        bool operator!=(const const_iterator &other) const { return !(*this == other); }
+        
+    private:
+        const std::vector<Bucket*> *buckets;
+        size_t bucket;
+        size_t pos;
+        
+        void skipEmpty() {
+            while (bucket < buckets->size() && pos >= (*buckets)[bucket]->entries.size()) {
+                bucket++;
+                pos = 0;
+            }
+        }
+    };
+    
+    const_iterator begin() const { return const_iterator(&buckets, 0); }
+    const_iterator end() const { return const_iterator(&buckets, buckets.size()); }
+    
+    void forEach(const EntryVisitor &visit) const override;
+    // Splits the bucket list evenly across threads; each bucket holds at most bucket_size entries
+    void parallelForEach(const EntryVisitor &visit, unsigned threads = 0) const override;
+
     
 private:
     int bucket_size; // Maximum number of entries in a bucket
+    int merge_threshold; // Buddy buckets merge when their combined size falls to this value
     int global_depth; // Global depth of the directory
     std::vector<Bucket*> directory; // Directory pointing to buckets
+    std::vector<Bucket*> buckets; // Every bucket exactly once, in no particular order; owns the buckets
+    std::vector<int> depth_count; // Number of buckets at each local depth
     
-    int hashKey(const std::string &key) const; // Hash function to compute the index for a key
+    size_t hashKey(const Key &key) const; // Full hash of a key; low bits select the directory slot
     void splitBucket(int index); // Split a bucket when it overflows
     Bucket* getBucket(int index) const; // Get the bucket corresponding to a directory index
     void doubleDirectory(); // Double the size of the directory when needed
+    void mergeBucket(int index); // Merge a bucket with its buddy while both are sparse enough
+    void shrinkDirectory(); // Halve the directory while no bucket needs the top depth bit
+    // Shared AMAC loop behind findBatch and findBatchHashed; key_at(i) returns the i-th key
+    template <class KeyAt>
+    size_t findBatchLoop(KeyAt key_at, const size_t *string_hashes, size_t count,
+                         int *values, bool *found, size_t group_size) const;
+    Bucket* newBucket(int local_depth); // Allocate a bucket and append it to the bucket list
+    void deleteBucket(Bucket* bucket); // Remove a bucket from the bucket list and free it
 };
 
+using ElasticHash = BasicElasticHash<std::string>;
+
+// Implemented in elastic_hash.cpp and explicitly instantiated for these key types only
+extern template class BasicElasticHash<std::string>;
+extern template class BasicElasticHash<InlineKey<8>>;
+extern template class BasicElasticHash<InlineKey<16>>;
+
 #endif // ELASTIC_HASH_HPP
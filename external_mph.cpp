@@ -0,0 +1,332 @@
+#include "external_mph.hpp"
+#include "hash_key.hpp"
+#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+namespace {
+
+// 每个分区的平均键数；分区内 g 值小于分区大小，必须放得进 uint16_t
+const uint64_t kPartitionSize = 4096;
+// 构造阶段读回溢出文件时每个键占用的内存（指纹 8 字节，排序原地进行），留一倍余量
+const size_t kBuildBytesPerKey = 16;
+const int kMaxSeedAttempts = 100;
+// 溢出文件的读写都不用流自带的缓冲，而是由调用方按这个大小成块读写，缓冲区计入内存预算
+const size_t kSpillBufferBytes = 8192;
+// 同时打开的溢出文件数上限，键再多也不会超出文件描述符限制
+const size_t kMaxFanOut = 64;
+
+uint32_t fastRange32(uint32_t x, uint32_t range) {
+    return static_cast<uint32_t>((static_cast<uint64_t>(x) * range) >> 32);
+}
+
+// 一个溢出文件及其负责的分区区间 [first, last)
+struct SpillRange {
+    std::string path;
+    uint64_t first;
+    uint64_t last;
+};
+
+// 构造结束（包括异常退出）时删除尚未处理的溢出文件
+struct SpillFiles {
+    std::vector<std::string> paths;
+    ~SpillFiles() {
+        for (const auto &path : paths) {
+            std::remove(path.c_str());
+        }
+    }
+};
+
+} // namespace
+
+ExternalPerfectHash::ExternalPerfectHash(const std::string &key_file, size_t memory_budget,
+                                         const std::string &spill_dir)
+    : n(0), spill_file_count(0), construction_time(0) {
+    uint64_t key_count = 0;
+    {
+        std::ifstream counter(key_file);
+        if (!counter)
+            throw std::runtime_error("Cannot open key file: " + key_file);
+        std::string line;
+        while (std::getline(counter, line)) {
+            if (!line.empty())
+                key_count++;
+        }
+    }
+    std::ifstream in(key_file);
+    if (!in)
+        throw std::runtime_error("Cannot open key file: " + key_file);
+    KeySource next_key = [&in](std::string &key) {
+        while (std::getline(in, key)) {
+            if (!key.empty())
+                return true;
+        }
+        return false;
+    };
+    build(next_key, key_count, memory_budget, spill_dir);
+}
+
+ExternalPerfectHash::ExternalPerfectHash(const KeySource &next_key, uint64_t key_count,
+                                         size_t memory_budget, const std::string &spill_dir)
+    : n(0), spill_file_count(0), construction_time(0) {
+    build(next_key, key_count, memory_budget, spill_dir);
+}
+
+// 64 位指纹：按 8 字节分块混合，长度参与最后一轮，不依赖 std::hash 的实现
+uint64_t ExternalPerfectHash::fingerprint(const std::string &key) {
+    uint64_t h = key.size();
+    size_t i = 0;
+    for (; i + 8 <= key.size(); i += 8) {
+        uint64_t word;
+        std::memcpy(&word, key.data() + i, sizeof(word));
+        h = hashWords(word, h, 0x9E3779B97F4A7C15ULL);
+    }
+    uint64_t tail = 0;
+    std::memcpy(&tail, key.data() + i, key.size() - i);
+    return hashWords(tail, h, key.size());
+}
+
+uint32_t ExternalPerfectHash::vertexCount(uint64_t partition_size) {
+    if (partition_size == 0)
+        return 0;
+    return static_cast<uint32_t>(partition_size * 5 / 2 + 2);
+}
+
+// 取指纹高 32 位做区间映射：分区号随指纹单调，排序后的指纹按分区连续排列
+size_t ExternalPerfectHash::partitionOf(uint64_t fp) const {
+    uint64_t partitions = partition_offsets.size() - 1;
+    return static_cast<size_t>(((fp >> 32) * partitions) >> 32);
+}
+
+void ExternalPerfectHash::build(const KeySource &next_key, uint64_t key_count, size_t memory_budget,
+                                const std::string &spill_dir) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    n = key_count;
+    
+    uint64_t partitions = std::max<uint64_t>(1, (n + kPartitionSize - 1) / kPartitionSize);
+    if (partitions > 0xFFFFFFFFULL)
+        throw std::length_error("Too many keys for ExternalPerfectHash");
+    partition_offsets.assign(partitions + 1, 0);
+    g_offsets.assign(partitions + 1, 0);
+    partition_seeds.assign(partitions, 0);
+    g.clear();
+    
+    // 读回构造时一个溢出文件的键数上限；分发时每个打开的文件占一块写缓冲，
+    // 加上一块读缓冲，同时打开的文件数受内存预算和 kMaxFanOut 限制
+    uint64_t keys_per_spill = std::max<uint64_t>(kPartitionSize, memory_budget / kBuildBytesPerKey);
+    size_t fan_out = std::min(kMaxFanOut, std::max<size_t>(2, memory_budget / kSpillBufferBytes - 1));
+    
+    std::string dir = spill_dir.empty() ? std::filesystem::temp_directory_path().string() : spill_dir;
+    std::string prefix = dir + "/mph_spill_" + std::to_string(reinterpret_cast<uintptr_t>(this)) + "_"
+        + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + "_";
+    SpillFiles files;
+    
+    // 把 next_fp 给出的指纹按分区区间 [first, last) 均分到 children 个新的溢出文件
+    auto split = [&](const std::function<bool(uint64_t &)> &next_fp, uint64_t first, uint64_t last,
+                     uint64_t children) {
+        uint64_t per_child = (last - first + children - 1) / children;
+        children = (last - first + per_child - 1) / per_child;
+        std::vector<SpillRange> ranges;
+        std::vector<std::ofstream> outs(children);
+        std::vector<std::vector<uint64_t>> buffers(children);
+        for (uint64_t c = 0; c < children; c++) {
+            files.paths.push_back(prefix + std::to_string(files.paths.size()) + ".bin");
+            ranges.push_back({files.paths.back(), first + c * per_child, std::min(last, first + (c + 1) * per_child)});
+            outs[c].rdbuf()->pubsetbuf(nullptr, 0);
+            outs[c].open(files.paths.back(), std::ios::binary | std::ios::trunc);
+            if (!outs[c])
+                throw std::runtime_error("Cannot create spill file: " + files.paths.back());
+            buffers[c].reserve(kSpillBufferBytes / sizeof(uint64_t));
+        }
+        auto flush = [&](size_t c) {
+            outs[c].write(reinterpret_cast<const char *>(buffers[c].data()), buffers[c].size() * sizeof(uint64_t));
+            buffers[c].clear();
+        };
+        uint64_t fp;
+        while (next_fp(fp)) {
+            size_t c = static_cast<size_t>((partitionOf(fp) - first) / per_child);
+            buffers[c].push_back(fp);
+            if (buffers[c].size() == buffers[c].capacity())
+                flush(c);
+        }
+        for (uint64_t c = 0; c < children; c++) {
+            flush(c);
+            outs[c].close();
+            if (!outs[c])
+                throw std::runtime_error("Failed to write spill file: " + ranges[c].path);
+        }
+        return ranges;
+    };
+    auto spillsFor = [&](uint64_t keys, uint64_t partition_count) {
+        return std::min<uint64_t>({fan_out, partition_count, std::max<uint64_t>(1, (keys + keys_per_spill - 1) / keys_per_spill)});
+    };
+    
+    // 第一阶段：流式读取键，把指纹追加到所属分区段的溢出文件
+    std::vector<SpillRange> pending;
+    {
+        std::string key;
+        uint64_t seen = 0;
+        pending = split([&](uint64_t &fp) {
+            if (!next_key(key))
+                return false;
+            fp = fingerprint(key);
+            seen++;
+            return true;
+        }, 0, partitions, spillsFor(n, partitions));
+        if (seen != n)
+            throw std::runtime_error("Key source produced " + std::to_string(seen) + " keys, expected " + std::to_string(n));
+    }
+    std::reverse(pending.begin(), pending.end());
+    
+    // 第二阶段：按分区顺序处理溢出文件。超过预算的文件再按分区细分一级（同样受 fan_out 限制），
+    // 否则读回、排序并逐个分区构造
+    std::vector<uint16_t> local_g;
+    while (!pending.empty()) {
+        SpillRange range = pending.back();
+        pending.pop_back();
+        std::ifstream in;
+        in.rdbuf()->pubsetbuf(nullptr, 0);
+        in.open(range.path, std::ios::binary | std::ios::ate);
+        if (!in)
+            throw std::runtime_error("Cannot open spill file: " + range.path);
+        uint64_t count = static_cast<uint64_t>(in.tellg()) / sizeof(uint64_t);
+        in.seekg(0);
+        
+        if (count > keys_per_spill && range.last - range.first > 1) {
+            std::vector<uint64_t> chunk(kSpillBufferBytes / sizeof(uint64_t));
+            size_t chunk_pos = 0, chunk_size = 0;
+            auto children = split([&](uint64_t &fp) {
+                if (chunk_pos == chunk_size) {
+                    in.read(reinterpret_cast<char *>(chunk.data()), chunk.size() * sizeof(uint64_t));
+                    chunk_size = static_cast<size_t>(in.gcount()) / sizeof(uint64_t);
+                    chunk_pos = 0;
+                    if (chunk_size == 0)
+                        return false;
+                }
+                fp = chunk[chunk_pos++];
+                return true;
+            }, range.first, range.last, spillsFor(count, range.last - range.first));
+            in.close();
+            std::remove(range.path.c_str());
+            pending.insert(pending.end(), children.rbegin(), children.rend());
+            continue;
+        }
+        
+        std::vector<uint64_t> fps(count);
+        if (!in.read(reinterpret_cast<char *>(fps.data()), count * sizeof(uint64_t)))
+            throw std::runtime_error("Failed to read spill file: " + range.path);
+        in.close();
+        std::remove(range.path.c_str());
+        
+        std::sort(fps.begin(), fps.end());
+        if (std::adjacent_find(fps.begin(), fps.end()) != fps.end())
+            throw std::runtime_error("Duplicate key (or 64-bit fingerprint collision) in ExternalPerfectHash input");
+        
+        size_t pos = 0;
+        for (uint64_t p = range.first; p < range.last; p++) {
+            size_t end = pos;
+            while (end < fps.size() && partitionOf(fps[end]) == p)
+                end++;
+            uint64_t part_count = end - pos;
+            if (part_count > 0xFFFF)
+                throw std::runtime_error("ExternalPerfectHash partition too large");
+            partition_offsets[p + 1] = partition_offsets[p] + part_count;
+            g_offsets[p + 1] = g_offsets[p] + vertexCount(part_count);
+            
+            bool built = part_count == 0;
+            for (int attempt = 0; attempt < kMaxSeedAttempts && !built; attempt++) {
+                uint32_t seed = static_cast<uint32_t>(hashWords(p, attempt));
+                if (buildPartition(fps.data() + pos, static_cast<uint32_t>(part_count), seed, local_g)) {
+                    partition_seeds[p] = seed;
+                    g.insert(g.end(), local_g.begin(), local_g.end());
+                    built = true;
+                }
+            }
+            if (!built)
+                throw std::runtime_error("Failed to construct ExternalPerfectHash partition " + std::to_string(p));
+            pos = end;
+        }
+    }
+    spill_file_count = files.paths.size();
+    g.shrink_to_fit();
+    
+    auto end_time = std::chrono::high_resolution_clock::now();
+    construction_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+}
+
+// 异或消除：每个顶点只记录度数和关联边编号的异或；度为 1 时异或值就是唯一剩下的那条边
+bool ExternalPerfectHash::buildPartition(const uint64_t *fps, uint32_t count, uint32_t seed,
+                                         std::vector<uint16_t> &out_g) const {
+    uint32_t m = vertexCount(count);
+    std::vector<uint32_t> eu(count), ev(count);
+    std::vector<uint32_t> deg(m, 0), xr(m, 0);
+    for (uint32_t e = 0; e < count; e++) {
+        uint64_t h = hashWords(fps[e], 0, seed);
+        uint32_t u = fastRange32(static_cast<uint32_t>(h), m);
+        uint32_t v = fastRange32(static_cast<uint32_t>(h >> 32), m);
+        if (u == v)
+            return false;
+        eu[e] = u;
+        ev[e] = v;
+        deg[u]++;
+        deg[v]++;
+        xr[u] ^= e;
+        xr[v] ^= e;
+    }
+    
+    std::vector<uint32_t> stack;
+    for (uint32_t v = 0; v < m; v++) {
+        if (deg[v] == 1)
+            stack.push_back(v);
+    }
+    std::vector<std::pair<uint32_t, uint32_t>> order;
+    order.reserve(count);
+    while (!stack.empty()) {
+        uint32_t v = stack.back();
+        stack.pop_back();
+        if (deg[v] != 1)
+            continue;
+        uint32_t e = xr[v];
+        order.push_back({v, e});
+        uint32_t w = (eu[e] == v) ? ev[e] : eu[e];
+        deg[v] = 0;
+        xr[w] ^= e;
+        if (--deg[w] == 1)
+            stack.push_back(w);
+    }
+    if (order.size() != count)
+        return false;
+    
+    out_g.assign(m, 0);
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        uint32_t v = it->first;
+        uint32_t e = it->second;
+        uint32_t w = (eu[e] == v) ? ev[e] : eu[e];
+        out_g[v] = static_cast<uint16_t>((e + count - out_g[w]) % count);
+    }
+    return true;
+}
+
+uint64_t ExternalPerfectHash::hash(const std::string &key) const {
+    uint64_t fp = fingerprint(key);
+    size_t p = partitionOf(fp);
+    uint64_t count = partition_offsets[p + 1] - partition_offsets[p];
+    if (count == 0)
+        return partition_offsets[p];
+    uint32_t m = static_cast<uint32_t>(g_offsets[p + 1] - g_offsets[p]);
+    uint64_t h = hashWords(fp, 0, partition_seeds[p]);
+    const uint16_t *pg = g.data() + g_offsets[p];
+    uint32_t u = fastRange32(static_cast<uint32_t>(h), m);
+    uint32_t v = fastRange32(static_cast<uint32_t>(h >> 32), m);
+    return partition_offsets[p] + (pg[u] + pg[v]) % count;
+}
+
+double ExternalPerfectHash::bitsPerKey() const {
+    if (n == 0)
+        return 0.0;
+    double bits = g.size() * 16.0 + partition_seeds.size() * (32.0 + 64.0 + 64.0);
+    return bits / n;
+}
@@ -0,0 +1,63 @@
+#ifndef EXTERNAL_MPH_HPP
+#define EXTERNAL_MPH_HPP
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include <stdexcept>
+
+// ExternalPerfectHash 是面向超大键集的分区 minimal perfect hash，构造时内存有上界：
+//   1. 流式读取键，每个键只算一次 64 位指纹，按指纹所属分区区间写入若干溢出文件；
+//      同时打开的文件数有上限（每个文件一块计入预算的写缓冲），键多时一级放不下，
+//      第二阶段再把超出预算的文件按分区区间逐级细分，因此内存与打开的文件数都与 n 无关；
+//   2. 按分区顺序读回溢出文件（大小受内存预算限制），排序后按分区构造：
+//      每个分区是一个小的 2-图，用"顶点度数 + 关联边编号异或"代替邻接表完成消除，
+//      再按消除逆序给 g 赋值（同 MinimalPerfectHash）。
+// 之后的所有计算都只用指纹，不再读取 key 字节。
+// 分区内 g 值小于分区大小，以 uint16_t 存放；内存预算不含最终的 g 数组本身
+// （约 2.5 × 2 字节/键）。
+class ExternalPerfectHash {
+public:
+    // 每次调用写入下一个键并返回 true，没有更多键时返回 false
+    using KeySource = std::function<bool(std::string &)>;
+    
+    static constexpr size_t kDefaultMemoryBudget = static_cast<size_t>(1) << 30;
+    
+    // 从文本文件构造（每行一个键），先扫描一遍计数，再扫描一遍写溢出文件
+    explicit ExternalPerfectHash(const std::string &key_file,
+                                 size_t memory_budget = kDefaultMemoryBudget,
+                                 const std::string &spill_dir = "");
+    
+    // 从迭代器式数据源构造，需事先给出键的数量
+    ExternalPerfectHash(const KeySource &next_key, uint64_t key_count,
+                        size_t memory_budget = kDefaultMemoryBudget,
+                        const std::string &spill_dir = "");
+    
+    // 返回 key 对应的下标（范围 [0, n-1]）；不在键集中的 key 返回任意下标
+    uint64_t hash(const std::string &key) const;
+    
+    uint64_t size() const { return n; }
+    size_t getPartitionCount() const { return partition_offsets.size() - 1; }
+    size_t getSpillFileCount() const { return spill_file_count; }
+    double bitsPerKey() const;
+    long long getConstructionTimeMs() const { return construction_time; }
+    
+private:
+    uint64_t n;
+    std::vector<uint64_t> partition_offsets;  // 分区 p 的键下标范围 [offsets[p], offsets[p+1])
+    std::vector<uint64_t> g_offsets;          // 分区 p 的 g 起始位置
+    std::vector<uint32_t> partition_seeds;
+    std::vector<uint16_t> g;
+    size_t spill_file_count;
+    long long construction_time;
+    
+    static uint64_t fingerprint(const std::string &key);
+    static uint32_t vertexCount(uint64_t partition_size);
+    size_t partitionOf(uint64_t fp) const;
+    
+    void build(const KeySource &next_key, uint64_t key_count, size_t memory_budget, const std::string &spill_dir);
+    bool buildPartition(const uint64_t *fps, uint32_t count, uint32_t seed, std::vector<uint16_t> &out_g) const;
+};
+
+#endif // EXTERNAL_MPH_HPP
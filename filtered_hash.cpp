@@ -0,0 +1,145 @@
+#include "filtered_hash.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// findBatch 每次先算出这么多个键的过滤器 hash 并预取其所在的块，再逐个检查
+const size_t kFilterChunk = 64;
+
+} // namespace
+
+FilteredHash::FilteredHash(std::unique_ptr<AbstractHash> table, size_t expected_keys, size_t bits_per_key)
+    : table(std::move(table)), filter(std::max<size_t>(expected_keys, 1), bits_per_key),
+      bits_per_key(bits_per_key), min_capacity(std::max<size_t>(expected_keys, 1)),
+      capacity(min_capacity), key_count(0), filter_keys(0), rebuild_count(0) {
+    this->table->forEach([this](const std::string &key, int) {
+        filter.add(BlockedBloomFilter::hashKey(key));
+        key_count++;
+    });
+    filter_keys = key_count;
+    if (key_count > capacity) {
+        rebuild(key_count * 2);
+        rebuild_count = 0;
+    }
+}
+
+// 按新的设计容量重新分配过滤器，并用表中现存的键重新填充
+void FilteredHash::rebuild(size_t new_capacity) {
+    capacity = std::max(new_capacity, min_capacity);
+    filter = BlockedBloomFilter(capacity, bits_per_key);
+    table->forEach([this](const std::string &key, int) {
+        filter.add(BlockedBloomFilter::hashKey(key));
+    });
+    filter_keys = key_count;
+    rebuild_count++;
+}
+
+void FilteredHash::insert(const std::string &key, int value) {
+    size_t string_hash = std::hash<std::string>{}(key);
+    uint64_t hash = BlockedBloomFilter::hashKey(string_hash, key.size());
+    // 新键绝大多数被过滤器直接判定为不存在，不必再查表
+    int old;
+    bool existed = filter.mayContain(hash) && table->tryFindHashed(key, string_hash, old);
+    table->insert(key, value);
+    if (existed)
+        return;
+    key_count++;
+    if (filter_keys >= capacity) {
+        rebuild(key_count * 2);  // 重建时新键已在表中
+        return;
+    }
+    filter.add(hash);
+    filter_keys++;
+}
+
+void FilteredHash::erase(const std::string &key) {
+    if (!filter.mayContain(BlockedBloomFilter::hashKey(key)))
+        throw std::runtime_error("Key not found in FilteredHash");
+    table->erase(key);  // 误判的键由被包装的表抛出异常
+    key_count--;
+    if (filter_keys - key_count > capacity / 2)
+        rebuild(key_count * 2);
+}
+
+int FilteredHash::find(const std::string &key) const {
+    int value;
+    if (!tryFind(key, value))
+        throw std::runtime_error("Key not found in FilteredHash");
+    return value;
+}
+
+bool FilteredHash::tryFind(const std::string &key, int &value) const {
+    return tryFindHashed(key, std::hash<std::string>{}(key), value);
+}
+
+bool FilteredHash::tryFindHashed(const std::string &key, size_t string_hash, int &value) const {
+    if (!filter.mayContain(BlockedBloomFilter::hashKey(string_hash, key.size())))
+        return false;
+    return table->tryFindHashed(key, string_hash, value);
+}
+
+size_t FilteredHash::findBatch(const std::string *keys, size_t count, int *values, bool *found,
+                               size_t group_size) const {
+    return filterBatch([keys](size_t i) -> const std::string & { return keys[i]; }, nullptr,
+                       count, values, found, group_size);
+}
+
+size_t FilteredHash::findBatchHashed(const std::string *const *keys, const size_t *string_hashes, size_t count,
+                                     int *values, bool *found, size_t group_size) const {
+    return filterBatch([keys](size_t i) -> const std::string & { return *keys[i]; }, string_hashes,
+                       count, values, found, group_size);
+}
+
+// 过滤器筛掉的键直接写 found = false；通过的键只收集指针、下标和 std::hash，
+// 整批只调用一次被包装表的批量查找，让表的批量实现始终有足够多的在途查找，再按下标写回
+template <class KeyAt>
+size_t FilteredHash::filterBatch(KeyAt key_at, const size_t *string_hashes, size_t count,
+                                 int *values, bool *found, size_t group_size) const {
+    std::vector<const std::string *> pass_keys;
+    std::vector<size_t> pass_hashes;
+    std::vector<size_t> pass_index;
+    size_t hashes[kFilterChunk];
+    uint64_t filter_hashes[kFilterChunk];
+    for (size_t base = 0; base < count; base += kFilterChunk) {
+        size_t n = std::min(kFilterChunk, count - base);
+        for (size_t j = 0; j < n; j++) {
+            const std::string &key = key_at(base + j);
+            hashes[j] = string_hashes ? string_hashes[base + j] : std::hash<std::string>{}(key);
+            filter_hashes[j] = BlockedBloomFilter::hashKey(hashes[j], key.size());
+            prefetchAddress(filter.blockAddress(filter_hashes[j]));
+        }
+        for (size_t j = 0; j < n; j++) {
+            size_t i = base + j;
+            found[i] = false;
+            if (!filter.mayContain(filter_hashes[j]))
+                continue;
+            pass_keys.push_back(&key_at(i));
+            pass_hashes.push_back(hashes[j]);
+            pass_index.push_back(i);
+        }
+    }
+    if (pass_keys.empty())
+        return 0;
+    
+    std::vector<int> pass_values(pass_keys.size());
+    std::unique_ptr<bool[]> pass_found(new bool[pass_keys.size()]);
+    size_t hits = table->findBatchHashed(pass_keys.data(), pass_hashes.data(), pass_keys.size(),
+                                         pass_values.data(), pass_found.get(), group_size);
+    for (size_t j = 0; j < pass_keys.size(); j++) {
+        size_t i = pass_index[j];
+        found[i] = pass_found[j];
+        if (pass_found[j])
+            values[i] = pass_values[j];
+    }
+    return hits;
+}
+
+void FilteredHash::forEach(const EntryVisitor &visit) const {
+    table->forEach(visit);
+}
+
+void FilteredHash::parallelForEach(const EntryVisitor &visit, unsigned threads) const {
+    table->parallelForEach(visit, threads);
+}
@@ -0,0 +1,56 @@
+#ifndef FILTERED_HASH_HPP
+#define FILTERED_HASH_HPP
+
+#include "abstract_hash.hpp"
+#include "bloom_filter.hpp"
+#include <string>
+#include <memory>
+
+// FilteredHash 在任意 AbstractHash 前加一层 BlockedBloomFilter，用于未命中占多数的场景：
+// 过滤器判定不存在的键只访问一个过滤器块就返回，不走表的探测序列（整条链、整个桶），
+// 命中的键则多一次过滤器访问。
+// 过滤器不支持删除：erase 只从表中删除，过滤器中的位保留，误判率随之升高；
+// 已删除键超过设计容量的一半，或键数超过设计容量时，用 forEach 遍历表重建过滤器。
+// 与被包装的表一样不支持多个线程并发调用
+class FilteredHash : public AbstractHash {
+public:
+    // table 可以已有表项，构造时据此建立过滤器；expected_keys 为过滤器的最小设计容量
+    explicit FilteredHash(std::unique_ptr<AbstractHash> table, size_t expected_keys = 1024, size_t bits_per_key = 16);
+
+    void insert(const std::string &key, int value) override;
+    void erase(const std::string &key) override;
+    int find(const std::string &key) const override;
+    bool tryFind(const std::string &key, int &value) const override;
+    // 先用过滤器筛掉不存在的键，通过的键以指针收集起来（不复制键），一次交给被包装表的批量查找
+    size_t findBatch(const std::string *keys, size_t count, int *values, bool *found,
+                     size_t group_size = 8) const override;
+    // 每个键只算一次 std::hash，过滤器与被包装的表共用
+    bool tryFindHashed(const std::string &key, size_t string_hash, int &value) const override;
+    size_t findBatchHashed(const std::string *const *keys, const size_t *string_hashes, size_t count,
+                           int *values, bool *found, size_t group_size = 8) const override;
+    void forEach(const EntryVisitor &visit) const override;
+    void parallelForEach(const EntryVisitor &visit, unsigned threads = 0) const override;
+
+    const AbstractHash &getTable() const { return *table; }
+    const BlockedBloomFilter &getFilter() const { return filter; }
+    size_t size() const { return key_count; }
+    size_t getRebuildCount() const { return rebuild_count; }
+
+private:
+    std::unique_ptr<AbstractHash> table;
+    BlockedBloomFilter filter;
+    size_t bits_per_key;
+    size_t min_capacity;
+    size_t capacity;      // 过滤器当前的设计容量
+    size_t key_count;
+    size_t filter_keys;   // 上次重建以来加入过滤器的键数，包括之后被删除的
+    size_t rebuild_count;
+
+    void rebuild(size_t new_capacity);
+    // findBatch 与 findBatchHashed 共用；key_at(i) 返回第 i 个键
+    template <class KeyAt>
+    size_t filterBatch(KeyAt key_at, const size_t *string_hashes, size_t count,
+                       int *values, bool *found, size_t group_size) const;
+};
+
+#endif // FILTERED_HASH_HPP
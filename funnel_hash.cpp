@@ -1,21 +1,58 @@
 #include "funnel_hash.hpp"
 
-FunnelHash::FunnelHash() {
+template <class Key>
+BasicFunnelHash<Key>::BasicFunnelHash() {
     // 可根据需求初始化
 }
 
-void FunnelHash::insert(const std::string &key, int value) {
-    map[key] = value;
+template <class Key>
+void BasicFunnelHash<Key>::insert(const std::string &key, int value) {
+    if (!KeyTraits<Key>::fits(key))
+        throw std::length_error("Key does not fit in FunnelHash key type");
+    map[KeyTraits<Key>::from(key)] = value;
 }
 
-void FunnelHash::erase(const std::string &key) {
-    if (map.erase(key) == 0)
+template <class Key>
+void BasicFunnelHash<Key>::erase(const std::string &key) {
+    if (map.erase(KeyTraits<Key>::from(key)) == 0)
         throw std::runtime_error("Key not found in FunnelHash");
 }
 
-int FunnelHash::find(const std::string &key) const {
-    auto it = map.find(key);
+template <class Key>
+int BasicFunnelHash<Key>::find(const std::string &key) const {
+    auto it = map.find(KeyTraits<Key>::from(key));
     if (it == map.end())
         throw std::runtime_error("Key not found in FunnelHash");
     return it->second;
 }
+
+template <class Key>
+bool BasicFunnelHash<Key>::tryFind(const std::string &key, int &value) const {
+    auto it = map.find(KeyTraits<Key>::from(key));
+    if (it == map.end())
+        return false;
+    value = it->second;
+    return true;
+}
+
+template <class Key>
+void BasicFunnelHash<Key>::forEach(const EntryVisitor &visit) const {
+    for (const auto &item : map) {
+        visit(KeyTraits<Key>::str(item.first), item.second);
+    }
+}
+
+template <class Key>
+void BasicFunnelHash<Key>::parallelForEach(const EntryVisitor &visit, unsigned threads) const {
+    forEachRange(map.bucket_count(), threads, [this, &visit](size_t begin, size_t end) {
+        for (size_t b = begin; b < end; b++) {
+            for (auto it = map.begin(b); it != map.end(b); ++it) {
+                visit(KeyTraits<Key>::str(it->first), it->second);
+            }
+        }
+    });
+}
+
+template class BasicFunnelHash<std::string>;
+template class BasicFunnelHash<InlineKey<8>>;
+template class BasicFunnelHash<InlineKey<16>>;
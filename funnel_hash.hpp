@@ -2,22 +2,42 @@
 #define FUNNEL_HASH_HPP
 
 #include "abstract_hash.hpp"
+#include "hash_key.hpp"
 #include <vector>
 #include <string>
 #include <stdexcept>
 #include <unordered_map>
 
-class FunnelHash : public AbstractHash {
+// Key 为 std::string 或短 key 特化 InlineKey<8>/InlineKey<16>
+template <class Key>
+class BasicFunnelHash : public AbstractHash {
 public:
-    FunnelHash();
+    BasicFunnelHash();
     
     // 修改接口名称：insert/erase/find
     void insert(const std::string &key, int value) override;
     void erase(const std::string &key) override;
     int find(const std::string &key) const override;
+    bool tryFind(const std::string &key, int &value) const override;
+    
+    // 遍历直接沿用 unordered_map 的前向迭代器，元素为 (key, value) 对
+    using const_iterator = typename std::unordered_map<Key, int, KeyHash<Key>>::const_iterator;
+    const_iterator begin() const { return map.begin(); }
+    const_iterator end() const { return map.end(); }
+    
+    void forEach(const EntryVisitor &visit) const override;
+    // 按 unordered_map 的桶下标切分区间，各线程用桶内迭代器扫描
+    void parallelForEach(const EntryVisitor &visit, unsigned threads = 0) const override;
     
 private:
-    std::unordered_map<std::string, int> map;
+    std::unordered_map<Key, int, KeyHash<Key>> map;
 };
 
+using FunnelHash = BasicFunnelHash<std::string>;
+
+// 实现位于 funnel_hash.cpp，仅显式实例化以下 key 类型
+extern template class BasicFunnelHash<std::string>;
+extern template class BasicFunnelHash<InlineKey<8>>;
+extern template class BasicFunnelHash<InlineKey<16>>;
+
 #endif // FUNNEL_HASH_HPP
@@ -0,0 +1,195 @@
+#ifndef HASH_KEY_HPP
+#define HASH_KEY_HPP
+
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+
+// 两个机器字的混合 hash（finalizer 取自 MurmurHash3 fmix64），低位同样均匀，
+// 可直接用于 ElasticHash 的目录掩码；constexpr 以便编译期构造（StaticPerfectHash）使用
+constexpr uint64_t hashWords(uint64_t lo, uint64_t hi, uint64_t seed = 0) {
+    uint64_t h = seed ^ (lo * 0x9E3779B97F4A7C15ULL);
+    uint64_t r = hi * 0xC2B2AE3D27D4EB4FULL;
+    h ^= (r << 31) | (r >> 33);
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// 定长内联 key：不超过 N 字节（N 为 8 或 16）且不含 '\0' 的短 key，
+// 零填充后打包进一到两个机器字，hash 与比较只需几条整数指令。
+// 打包按小端序（x86/ARM）把第 i 个字节放在第 8*i 位
+template <size_t N>
+class InlineKey {
+    static_assert(N == 8 || N == 16, "InlineKey supports 8 or 16 byte keys");
+public:
+    static constexpr size_t kWords = N / 8;
+    
+    InlineKey() : words{} {}
+    explicit InlineKey(const std::string &key) : InlineKey(pack(key)) {
+        if (!valid())
+            throw std::length_error("Key does not fit in InlineKey");
+    }
+    
+    // 打包 key；超长或含 '\0' 时返回 valid() 为 false 的哨兵，
+    // 哨兵不等于任何合法 key，查找时可直接用它得到"未找到"
+    static InlineKey pack(const std::string &key) {
+        size_t len = key.size();
+        if (len > N)
+            return invalid();
+        const char *p = key.data();
+        uint64_t lo = 0, hi = 0;
+        // 用两次重叠的定长读取代替逐字节拷贝
+        if (len >= 8) {
+            lo = load64(p);
+            if (N > 8 && len > 8)
+                hi = load64(p + len - 8) >> (8 * (16 - len));
+        } else if (len >= 4) {
+            lo = load32(p) | (static_cast<uint64_t>(load32(p + len - 4)) << (8 * (len - 4)));
+        } else if (len > 0) {
+            lo = static_cast<uint64_t>(static_cast<unsigned char>(p[0]))
+               | static_cast<uint64_t>(static_cast<unsigned char>(p[len / 2])) << (8 * (len / 2))
+               | static_cast<uint64_t>(static_cast<unsigned char>(p[len - 1])) << (8 * (len - 1));
+        }
+        if (hasZeroByte(lo, len < 8 ? len : 8) || (len > 8 && hasZeroByte(hi, len - 8)))
+            return invalid();
+        InlineKey k;
+        k.words[0] = lo;
+        if (kWords > 1)
+            k.words[kWords - 1] = hi;
+        return k;
+    }
+    
+    static bool fits(const std::string &key) { return pack(key).valid(); }
+    
+    // 合法打包中 '\0' 只出现在末尾的填充部分，首字节为 0 而次字节非 0 的模式不会出现
+    bool valid() const { return words[0] != kInvalidWord; }
+    
+    // 8 字节 key 的高位字恒为 0，与 16 字节打包结果一致
+    uint64_t lo() const { return words[0]; }
+    uint64_t hi() const { return kWords > 1 ? words[kWords - 1] : 0; }
+    size_t hash() const { return hashWords(lo(), hi()); }
+    
+    std::string str() const {
+        std::string key;
+        for (size_t i = 0; i < N; i++) {
+            char c = static_cast<char>(words[i / 8] >> (8 * (i % 8)));
+            if (c == '\0')
+                break;
+            key.push_back(c);
+        }
+        return key;
+    }
+    
+    bool operator==(const InlineKey &other) const {
+        return lo() == other.lo() && hi() == other.hi();
+    }
+    bool operator!=(const InlineKey &other) const { return !(*this == other); }
+    
+private:
+    static constexpr uint64_t kInvalidWord = 0xFF00;
+    
+    uint64_t words[kWords];
+    
+    static InlineKey invalid() {
+        InlineKey k;
+        k.words[0] = kInvalidWord;
+        return k;
+    }
+    
+    static uint64_t load64(const char *p) {
+        uint64_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+    
+    static uint32_t load32(const char *p) {
+        uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+    
+    // w 的低 n 个字节中是否有 0（n <= 8），其余字节先填成非 0
+    static bool hasZeroByte(uint64_t w, size_t n) {
+        const uint64_t ones = 0x0101010101010101ULL;
+        uint64_t t = w | (n >= 8 ? 0 : ones << (8 * n));
+        return ((t - ones) & ~t & (ones << 7)) != 0;
+    }
+};
+
+// 批量查找时对下一跳地址发出预取；不支持的编译器上为空操作
+inline void prefetchAddress(const void *addr) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(addr);
+#else
+    (void)addr;
+#endif
+}
+
+// 各散列表通过 KeyTraits 把接口上的 std::string 转为内部存储的 key 类型；
+// 插入前用 fits 检查，查找/删除直接用 from，放不下的 key 不会命中任何表项
+template <class Key>
+struct KeyTraits;
+
+template <>
+struct KeyTraits<std::string> {
+    static bool fits(const std::string &) { return true; }
+    static const std::string &from(const std::string &key) { return key; }
+    static size_t hash(const std::string &key) { return std::hash<std::string>{}(key); }
+    // 调用方已算出原始字符串的 std::hash 时直接复用
+    static size_t hash(const std::string &, size_t string_hash) { return string_hash; }
+    static const void *address(const std::string &key) { return key.data(); }
+    static const std::string &str(const std::string &key) { return key; }
+};
+
+template <size_t N>
+struct KeyTraits<InlineKey<N>> {
+    static bool fits(const std::string &key) { return InlineKey<N>::fits(key); }
+    // 不合法的 key 得到哨兵，查找自然落空；插入前由调用方先检查 fits
+    static InlineKey<N> from(const std::string &key) { return InlineKey<N>::pack(key); }
+    static size_t hash(const InlineKey<N> &key) { return key.hash(); }
+    static size_t hash(const InlineKey<N> &key, size_t) { return key.hash(); }
+    static const void *address(const InlineKey<N> &key) { return &key; }
+    static std::string str(const InlineKey<N> &key) { return key.str(); }
+};
+
+template <class Key>
+struct KeyHash {
+    size_t operator()(const Key &key) const { return KeyTraits<Key>::hash(key); }
+};
+
+// 链表/桶中的表项：缓存完整的 64 位 hash，
+// 分裂和重散列时不必再读取 key，查找时先比较 hash 再比较字符串
+template <class Key>
+struct BasicHashEntry {
+    Key key;
+    int value;
+    size_t hash;
+    
+    size_t hashValue() const { return hash; }
+    bool hashMatches(size_t h) const { return hash == h; }
+    bool matches(size_t h, const Key &k) const { return hash == h && key == k; }
+};
+
+// 内联 key 重新计算 hash 比读取缓存更便宜，不再额外存储
+template <size_t N>
+struct BasicHashEntry<InlineKey<N>> {
+    InlineKey<N> key;
+    int value;
+    
+    BasicHashEntry(const InlineKey<N> &key, int value, size_t) : key(key), value(value) {}
+    
+    size_t hashValue() const { return key.hash(); }
+    bool hashMatches(size_t) const { return true; }
+    bool matches(size_t, const InlineKey<N> &k) const { return key == k; }
+};
+
+using HashEntry = BasicHashEntry<std::string>;
+
+#endif // HASH_KEY_HPP
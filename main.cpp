@@ -6,11 +6,35 @@
 #include "simple_hash.hpp"
 #include "elastic_hash.hpp"
 #include "funnel_hash.hpp"
+#include "workload.hpp"
+#include "perf_counters.hpp"
+#include "sharded_hash.hpp"
+#include "dynamic_mph.hpp"
+#include "external_mph.hpp"
+#include "static_mph.hpp"
+#include "adaptive_hash.hpp"
+#include "cuckoo_hash.hpp"
+#include "filtered_hash.hpp"
 #include <chrono>
 #include <fstream>
+#include <thread>
+#include <mutex>
+#include <memory>
+#include <array>
+#include <algorithm>
+#include <atomic>
 
 using namespace std;
 
+// C 语言关键字表：键集在编译期已知，MPH 在编译期构造
+constexpr array<string_view, 32> kCKeywordNames = {
+    "auto", "break", "case", "char", "const", "continue", "default", "do",
+    "double", "else", "enum", "extern", "float", "for", "goto", "if",
+    "int", "long", "register", "return", "short", "signed", "sizeof", "static",
+    "struct", "switch", "typedef", "union", "unsigned", "void", "volatile", "while"
+};
+constexpr StaticPerfectHash<32> kCKeywords(kCKeywordNames);
+
 // 生成固定长度的随机字符串
 string random_string(size_t length, mt19937 &rng) {
     static const string chars = "abcdefghijklmnopqrstuvwxyz";
@@ -22,18 +46,98 @@ string random_string(size_t length, mt19937 &rng) {
     return s;
 }
 
+// 对一张表重复查询给定键集，返回耗时（毫秒）
+long long time_lookups(const AbstractHash &table, const vector<string> &keys, int rounds) {
+    auto start = chrono::high_resolution_clock::now();
+    volatile int sum = 0;
+    for (int i = 0; i < rounds; i++) {
+        for (const auto &key : keys) {
+            sum += table.find(key);
+        }
+    }
+    auto end = chrono::high_resolution_clock::now();
+    return chrono::duration_cast<chrono::milliseconds>(end - start).count();
+}
+
+// 在各动态散列表上回放同一负载，输出一行结果
+void run_workload(const string &name, const Workload &workload) {
+    size_t capacity = max<size_t>(workload.getPreloadKeys().size() * 2, 101);
+    SimpleHash sh(capacity);
+    ElasticHash eh(4);
+    FunnelHash fh;
+    ReplayResult sh_result = workload.replay(sh);
+    ReplayResult eh_result = workload.replay(eh);
+    ReplayResult fh_result = workload.replay(fh);
+    cout << name << "\t" << sh_result.elapsed_ms << "\t\t" << eh_result.elapsed_ms
+         << "\t\t" << fh_result.elapsed_ms << "\t\t" << sh_result.misses << endl;
+}
+
+// 多个线程并发写入：每个线程插入自己那一份键，再删除其中一半；
+// global_lock 非空时所有操作都串行在这把全局锁上（对照组）
+long long concurrent_writes(AbstractHash &table, const vector<string> &keys, int threads, mutex *global_lock) {
+    auto worker = [&](int tid) {
+        for (size_t i = tid; i < keys.size(); i += threads) {
+            if (global_lock) {
+                lock_guard<mutex> guard(*global_lock);
+                table.insert(keys[i], static_cast<int>(i));
+            } else {
+                table.insert(keys[i], static_cast<int>(i));
+            }
+        }
+        for (size_t i = tid; i < keys.size(); i += 2 * threads) {
+            if (global_lock) {
+                lock_guard<mutex> guard(*global_lock);
+                table.erase(keys[i]);
+            } else {
+                table.erase(keys[i]);
+            }
+        }
+    };
+    auto start = chrono::high_resolution_clock::now();
+    vector<thread> pool;
+    for (int t = 0; t < threads; t++) {
+        pool.emplace_back(worker, t);
+    }
+    for (auto &th : pool) {
+        th.join();
+    }
+    auto end = chrono::high_resolution_clock::now();
+    return chrono::duration_cast<chrono::milliseconds>(end - start).count();
+}
+
+// 批量查找 rounds 次，返回耗时（毫秒）
+long long time_batch_lookups(const AbstractHash &table, const vector<string> &keys, size_t group_size, int rounds) {
+    vector<int> values(keys.size());
+    unique_ptr<bool[]> found(new bool[keys.size()]);
+    auto start = chrono::high_resolution_clock::now();
+    volatile size_t hits = 0;
+    for (int i = 0; i < rounds; i++) {
+        hits += table.findBatch(keys.data(), keys.size(), values.data(), found.get(), group_size);
+    }
+    auto end = chrono::high_resolution_clock::now();
+    return chrono::duration_cast<chrono::milliseconds>(end - start).count();
+}
+
 // 添加到 main 函数前：负载测试函数
 void load_test(const vector<vector<string>>& test_sets, ostream& out) {
     // Simple CSV header without Chinese characters
     out << "# Load Test Results" << endl;
-    out << "size,mph_lookup_ms,sh_lookup_ms,eh_lookup_ms,fh_lookup_ms" << endl;
+    // 每个计时区间同时读取硬件计数器，按单次查询归一化后追加在毫秒列之后
+    PerfCounters counters;
+    if (!counters.available())
+        cout << "Hardware performance counters unavailable; counter columns left empty" << endl;
+    out << "size,mph_lookup_ms,sh_lookup_ms,eh_lookup_ms,fh_lookup_ms"
+        << PerfCounters::csvHeader("mph") << PerfCounters::csvHeader("sh")
+        << PerfCounters::csvHeader("eh") << PerfCounters::csvHeader("fh") << endl;
     
     // 对每组测试数据分别测试
     for (const auto& keys : test_sets) {
         int size = keys.size();
+        long long ops = 10000LL * size;
         
         // MinimalPerfectHash测试
         MinimalPerfectHash mph(keys);
+        counters.start();
         auto mph_lookup_start = chrono::high_resolution_clock::now();
         volatile int mph_sum = 0;
         for (int i = 0; i < 10000; i++) {
@@ -42,6 +146,7 @@ void load_test(const vector<vector<string>>& test_sets, ostream& out) {
             }
         }
         auto mph_lookup_end = chrono::high_resolution_clock::now();
+        PerfSample mph_counters = counters.stop();
         auto mph_lookup_time = chrono::duration_cast<chrono::milliseconds>(mph_lookup_end - mph_lookup_start).count();
         
         // SimpleHash测试
@@ -49,6 +154,7 @@ void load_test(const vector<vector<string>>& test_sets, ostream& out) {
         for (const auto &key : keys) {
             sh.insert(key, mph.hash(key));
         }
+        counters.start();
         auto sh_lookup_start = chrono::high_resolution_clock::now();
         volatile int sh_sum = 0;
         for (int i = 0; i < 10000; i++) {
@@ -57,6 +163,7 @@ void load_test(const vector<vector<string>>& test_sets, ostream& out) {
             }
         }
         auto sh_lookup_end = chrono::high_resolution_clock::now();
+        PerfSample sh_counters = counters.stop();
         auto sh_lookup_time = chrono::duration_cast<chrono::milliseconds>(sh_lookup_end - sh_lookup_start).count();
         
         // ElasticHash测试
@@ -64,6 +171,7 @@ void load_test(const vector<vector<string>>& test_sets, ostream& out) {
         for (const auto &key : keys) {
             eh.insert(key, mph.hash(key));
         }
+        counters.start();
         auto eh_lookup_start = chrono::high_resolution_clock::now();
         volatile int eh_sum = 0;
         for (int i = 0; i < 10000; i++) {
@@ -72,6 +180,7 @@ void load_test(const vector<vector<string>>& test_sets, ostream& out) {
             }
         }
         auto eh_lookup_end = chrono::high_resolution_clock::now();
+        PerfSample eh_counters = counters.stop();
         auto eh_lookup_time = chrono::duration_cast<chrono::milliseconds>(eh_lookup_end - eh_lookup_start).count();
         
         // FunnelHash测试
@@ -79,6 +188,7 @@ void load_test(const vector<vector<string>>& test_sets, ostream& out) {
         for (const auto &key : keys) {
             fh.insert(key, mph.hash(key));
         }
+        counters.start();
         auto fh_lookup_start = chrono::high_resolution_clock::now();
         volatile int fh_sum = 0;
         for (int i = 0; i < 10000; i++) {
@@ -87,14 +197,30 @@ void load_test(const vector<vector<string>>& test_sets, ostream& out) {
             }
         }
         auto fh_lookup_end = chrono::high_resolution_clock::now();
+        PerfSample fh_counters = counters.stop();
         auto fh_lookup_time = chrono::duration_cast<chrono::milliseconds>(fh_lookup_end - fh_lookup_start).count();
         
         // 输出当前大小的测试结果 - 只输出数字，不包含中文
-        out << size << "," << mph_lookup_time << "," << sh_lookup_time << "," << eh_lookup_time << "," << fh_lookup_time << endl;
+        out << size << "," << mph_lookup_time << "," << sh_lookup_time << "," << eh_lookup_time << "," << fh_lookup_time
+            << PerfCounters::csvFields(mph_counters, ops) << PerfCounters::csvFields(sh_counters, ops)
+            << PerfCounters::csvFields(eh_counters, ops) << PerfCounters::csvFields(fh_counters, ops) << endl;
     }
 }
 
-int main() {
+int main(int argc, char *argv[]) {
+    // 传入 trace 文件时只回放该 trace
+    if (argc > 1) {
+        try {
+            Workload trace = Workload::loadTrace(argv[1]);
+            cout << "Trace\t\tSimpleHash(ms)\tElasticHash(ms)\tFunnelHash(ms)\tMisses" << endl;
+            run_workload(argv[1], trace);
+        } catch (const std::runtime_error &e) {
+            cerr << e.what() << endl;
+            return 1;
+        }
+        return 0;
+    }
+    
     // 固定随机种子
     mt19937 rng(42);
     
@@ -229,6 +355,441 @@ int main() {
         }
     }
     
+    // === 负载模型测试：偏斜访问、未命中与插入/删除混合 ===
+    cout << "\n=== 负载模型测试 (Workload Scenarios) ===" << endl;
+    cout << "Workload\tSimpleHash(ms)\tElasticHash(ms)\tFunnelHash(ms)\tMisses" << endl;
+    {
+        WorkloadConfig config;
+        config.key_count = 20000;
+        config.operation_count = 200000;
+        run_workload("uniform", Workload::generate(config));
+        
+        config.distribution = AccessDistribution::Zipfian;
+        run_workload("zipf-0.99", Workload::generate(config));
+        
+        config.distribution = AccessDistribution::HotSet;
+        config.miss_ratio = 0.2;
+        run_workload("hot+20%miss", Workload::generate(config));
+        
+        config.distribution = AccessDistribution::Zipfian;
+        config.miss_ratio = 0.0;
+        config.insert_ratio = 0.1;
+        config.erase_ratio = 0.1;
+        config.length_distribution = KeyLengthDistribution::Normal;
+        config.min_key_length = 4;
+        config.max_key_length = 64;
+        config.mean_key_length = 24.0;
+        config.key_length_stddev = 12.0;
+        run_workload("mixed-10/10", Workload::generate(config));
+    }
+    
+    // === 多线程写入扩展性：全局锁 SimpleHash 与分段锁 ShardedSimpleHash ===
+    cout << "\n=== 多线程写入扩展性 (Multi-writer scaling) ===" << endl;
+    cout << "Threads\tGlobalLock(ms)\tSharded(ms)" << endl;
+    {
+        vector<string> writer_keys;
+        mt19937 writer_rng(31);
+        for (int i = 0; i < 400000; i++) {
+            writer_keys.push_back(random_string(10, writer_rng));
+        }
+        for (int threads : {1, 2, 4, 8}) {
+            SimpleHash locked_hash(writer_keys.size());
+            mutex global_lock;
+            ShardedSimpleHash sharded_hash(writer_keys.size(), 64);
+            long long locked_time = concurrent_writes(locked_hash, writer_keys, threads, &global_lock);
+            long long sharded_time = concurrent_writes(sharded_hash, writer_keys, threads, nullptr);
+            cout << threads << "\t" << locked_time << "\t\t" << sharded_time << endl;
+        }
+    }
+    
+    // === 批量交错查找：超出缓存的大表上对比逐个查找与 AMAC 批量查找 ===
+    cout << "\n=== 批量交错查找 (AMAC batched lookup) ===" << endl;
+    cout << "Mode\t\tSimpleHash(ms)\tElasticHash(ms)" << endl;
+    {
+        vector<string> big_keys;
+        mt19937 big_rng(32);
+        for (int i = 0; i < 500000; i++) {
+            big_keys.push_back(random_string(20, big_rng)); // 超过 SSO 长度，key 存放在堆上
+        }
+        SimpleHash big_sh(big_keys.size());
+        ElasticHash big_eh(4);
+        for (size_t i = 0; i < big_keys.size(); i++) {
+            big_sh.insert(big_keys[i], static_cast<int>(i));
+            big_eh.insert(big_keys[i], static_cast<int>(i));
+        }
+        vector<string> queries = big_keys;
+        shuffle(queries.begin(), queries.end(), big_rng);
+        
+        cout << "find\t\t" << time_lookups(big_sh, queries, 3)
+             << "\t\t" << time_lookups(big_eh, queries, 3) << endl;
+        for (size_t group : {1, 4, 8, 16}) {
+            cout << "batch(" << group << ")\t" << time_batch_lookups(big_sh, queries, group, 3)
+                 << "\t\t" << time_batch_lookups(big_eh, queries, group, 3) << endl;
+        }
+    }
+    
+    // === 动态 MPH：增量层 + 后台重建 ===
+    cout << "\n=== 动态 MPH (DynamicPerfectHash) ===" << endl;
+    {
+        vector<string> dict_keys;
+        mt19937 dict_rng(33);
+        for (int i = 0; i < 100000; i++) {
+            dict_keys.push_back(random_string(10, dict_rng));
+        }
+        auto build_start = chrono::high_resolution_clock::now();
+        DynamicPerfectHash dict(dict_keys, {}, 2000);
+        auto build_end = chrono::high_resolution_clock::now();
+        cout << "Initial build (" << dict_keys.size() << " keys): "
+             << chrono::duration_cast<chrono::milliseconds>(build_end - build_start).count() << " ms" << endl;
+        cout << "Lookups, static only: " << time_lookups(dict, dict_keys, 5) << " ms" << endl;
+        
+        // 插入触发后台重建，重建期间查询照常进行
+        for (int i = 0; i < 2000; i++) {
+            dict.insert(random_string(11, dict_rng), i);
+        }
+        cout << "Lookups during rebuild (rebuilding=" << dict.isRebuilding() << "): "
+             << time_lookups(dict, dict_keys, 5) << " ms" << endl;
+        auto merge_start = chrono::high_resolution_clock::now();
+        dict.rebuild();
+        auto merge_end = chrono::high_resolution_clock::now();
+        cout << "Wait for rebuild: " << chrono::duration_cast<chrono::milliseconds>(merge_end - merge_start).count()
+             << " ms, static keys " << dict.getStaticSize() << ", delta " << dict.getDeltaSize() << endl;
+        cout << "Lookups after rebuild: " << time_lookups(dict, dict_keys, 5) << " ms" << endl;
+
+        // 超过 16 字节的长 key 走分块 hash 路径，构造与查询开销应与短 key 同一量级
+        for (size_t length : {10, 24, 64}) {
+            vector<string> sized_keys;
+            for (int i = 0; i < 20000; i++) {
+                sized_keys.push_back(random_string(length, dict_rng));
+            }
+            auto sized_start = chrono::high_resolution_clock::now();
+            DynamicPerfectHash sized(sized_keys);
+            auto sized_end = chrono::high_resolution_clock::now();
+            cout << "Key length " << length << ": build "
+                 << chrono::duration_cast<chrono::milliseconds>(sized_end - sized_start).count()
+                 << " ms, 20 x " << sized_keys.size() << " lookups " << time_lookups(sized, sized_keys, 20) << " ms" << endl;
+        }
+    }
+
+    // === 外存 MPH：从键文件流式构造，内存预算远小于键集合 ===
+    cout << "\n=== 外存 MPH (ExternalPerfectHash) ===" << endl;
+    {
+        string key_file = "external_mph_keys.txt";
+        mt19937 file_rng(34);
+        vector<string> file_keys;
+        {
+            ofstream out(key_file);
+            for (int i = 0; i < 200000; i++) {
+                file_keys.push_back(random_string(12, file_rng) + to_string(i));
+                out << file_keys.back() << "\n";
+            }
+        }
+        try {
+            ExternalPerfectHash ext(key_file, 512 * 1024, ".");
+            // 验证 hash 是 [0, n) 上的双射
+            vector<bool> used(ext.size(), false);
+            bool bijective = true;
+            for (const auto &key : file_keys) {
+                uint64_t h = ext.hash(key);
+                if (h >= ext.size() || used[h])
+                    bijective = false;
+                else
+                    used[h] = true;
+            }
+            auto lookup_start = chrono::high_resolution_clock::now();
+            uint64_t checksum = 0;
+            for (const auto &key : file_keys) {
+                checksum += ext.hash(key);
+            }
+            auto lookup_end = chrono::high_resolution_clock::now();
+            cout << "Keys: " << ext.size() << ", partitions: " << ext.getPartitionCount()
+                 << ", spill files: " << ext.getSpillFileCount() << ", budget: 512 KB" << endl;
+            cout << "Build: " << ext.getConstructionTimeMs() << " ms, bits/key: " << ext.bitsPerKey()
+                 << ", bijective: " << (bijective ? "yes" : "no") << endl;
+            cout << "Lookups: " << chrono::duration_cast<chrono::milliseconds>(lookup_end - lookup_start).count()
+                 << " ms (checksum " << checksum << ")" << endl;
+        } catch (const exception &e) {
+            cout << "ExternalPerfectHash failed: " << e.what() << endl;
+        }
+        remove(key_file.c_str());
+    }
+
+    // === 编译期 MPH：关键字表在编译期构造，运行时只做查找 ===
+    cout << "\n=== 编译期 MPH (StaticPerfectHash) ===" << endl;
+    {
+        static_assert(kCKeywords.find("while") == 31, "keyword index must be known at compile time");
+        vector<string> keyword_keys(kCKeywordNames.begin(), kCKeywordNames.end());
+        auto build_start = chrono::high_resolution_clock::now();
+        MinimalPerfectHash runtime_mph(keyword_keys);
+        auto build_end = chrono::high_resolution_clock::now();
+        cout << "Keywords: " << kCKeywords.size() << ", runtime MinimalPerfectHash build: "
+             << chrono::duration_cast<chrono::microseconds>(build_end - build_start).count()
+             << " us, StaticPerfectHash build: 0 us (seed " << kCKeywords.getSeed() << ")" << endl;
+        
+        const int rounds = 200000;
+        auto static_start = chrono::high_resolution_clock::now();
+        volatile int static_sum = 0;
+        for (int i = 0; i < rounds; i++) {
+            for (const auto &key : keyword_keys) {
+                static_sum += kCKeywords.find(key);
+            }
+        }
+        auto static_end = chrono::high_resolution_clock::now();
+        auto runtime_start = chrono::high_resolution_clock::now();
+        volatile int runtime_sum = 0;
+        for (int i = 0; i < rounds; i++) {
+            for (const auto &key : keyword_keys) {
+                runtime_sum += runtime_mph.hash(key);
+            }
+        }
+        auto runtime_end = chrono::high_resolution_clock::now();
+        cout << "Lookups (" << rounds << " x " << keyword_keys.size() << "): StaticPerfectHash::find "
+             << chrono::duration_cast<chrono::milliseconds>(static_end - static_start).count()
+             << " ms, MinimalPerfectHash::hash "
+             << chrono::duration_cast<chrono::milliseconds>(runtime_end - runtime_start).count() << " ms" << endl;
+    }
+
+    // === 全表遍历：迭代器、forEach 与按物理存储切分的 parallelForEach ===
+    cout << "\n=== 全表遍历 (Full-table scan) ===" << endl;
+    {
+        mt19937 scan_rng(36);
+        SimpleHash scan_sh(250000);
+        ElasticHash scan_eh(16);
+        FunnelHash scan_fh;
+        for (int i = 0; i < 500000; i++) {
+            string key = random_string(12, scan_rng);
+            scan_sh.insert(key, i);
+            scan_eh.insert(key, i);
+            scan_fh.insert(key, i);
+        }
+        unsigned threads = max(1u, thread::hardware_concurrency());
+        cout << "Table\titerator(ms)\tforEach(ms)\tparallel x" << threads << "(ms)\tentries" << endl;
+        auto scan = [threads](const string &name, const AbstractHash &table, long long iterator_ms) {
+            atomic<long long> serial_sum(0), parallel_sum(0);
+            auto serial_start = chrono::high_resolution_clock::now();
+            table.forEach([&](const string &, int value) {
+                serial_sum.fetch_add(value, memory_order_relaxed);
+            });
+            auto serial_end = chrono::high_resolution_clock::now();
+            atomic<size_t> entries(0);
+            table.parallelForEach([&](const string &, int value) {
+                parallel_sum.fetch_add(value, memory_order_relaxed);
+                entries.fetch_add(1, memory_order_relaxed);
+            }, threads);
+            auto parallel_end = chrono::high_resolution_clock::now();
+            cout << name << "\t" << iterator_ms << "\t\t"
+                 << chrono::duration_cast<chrono::milliseconds>(serial_end - serial_start).count() << "\t\t"
+                 << chrono::duration_cast<chrono::milliseconds>(parallel_end - serial_end).count() << "\t\t"
+                 << entries.load() << (serial_sum.load() == parallel_sum.load() ? "" : " (sum mismatch)") << endl;
+        };
+        // 迭代器是内联的非虚调用，作为顺序扫描的下限参考
+        auto time_iterator = [](const auto &table) {
+            auto start = chrono::high_resolution_clock::now();
+            volatile long long sum = 0;
+            for (const auto &entry : table) {
+                sum += entry.value;
+            }
+            auto end = chrono::high_resolution_clock::now();
+            return static_cast<long long>(chrono::duration_cast<chrono::milliseconds>(end - start).count());
+        };
+        scan("SimpleHash", scan_sh, time_iterator(scan_sh));
+        scan("ElasticHash", scan_eh, time_iterator(scan_eh));
+        auto fh_start = chrono::high_resolution_clock::now();
+        volatile long long fh_sum = 0;
+        for (const auto &item : scan_fh) {
+            fh_sum += item.second;
+        }
+        auto fh_end = chrono::high_resolution_clock::now();
+        scan("FunnelHash", scan_fh, chrono::duration_cast<chrono::milliseconds>(fh_end - fh_start).count());
+    }
+
+    // === 自适应散列：按观测到的负载在实现之间迁移 ===
+    cout << "\n=== 自适应散列 (AdaptiveHash) ===" << endl;
+    {
+        mt19937 adaptive_rng(37);
+        vector<string> adaptive_keys;
+        for (int i = 0; i < 200000; i++) {
+            adaptive_keys.push_back(random_string(10, adaptive_rng));
+        }
+        AdaptiveHash adaptive(1024);
+        SimpleHash fixed(1024);  // 对照组：按初始规模选定后不再调整
+        auto report = [&](const string &phase, long long adaptive_ms, long long fixed_ms) {
+            cout << phase << "\tAdaptiveHash " << adaptive_ms << " ms, SimpleHash(1024) " << fixed_ms
+                 << " ms, mode " << AdaptiveHash::modeName(adaptive.getMode())
+                 << ", migrations " << adaptive.getMigrationCount() << endl;
+        };
+        auto time_inserts = [&](AbstractHash &table, int offset) {
+            auto start = chrono::high_resolution_clock::now();
+            for (size_t i = 0; i < adaptive_keys.size(); i++) {
+                table.insert(adaptive_keys[i], static_cast<int>(i) + offset);
+            }
+            auto end = chrono::high_resolution_clock::now();
+            return static_cast<long long>(chrono::duration_cast<chrono::milliseconds>(end - start).count());
+        };
+        
+        // 写入阶段：容量随键数增长而迁移
+        long long adaptive_ms = time_inserts(adaptive, 0);
+        long long fixed_ms = time_inserts(fixed, 0);
+        adaptive.waitForMigration();
+        report("Insert 200k", adaptive_ms, fixed_ms);
+        
+        // 只读阶段：一个窗口内没有写操作后尝试冻结为 MPH 静态层；
+        // 后台抽样比较发现 MPH 不比当前实现快时放弃冻结，模式保持不变
+        adaptive_ms = time_lookups(adaptive, adaptive_keys, 1);
+        fixed_ms = time_lookups(fixed, adaptive_keys, 1);
+        adaptive.waitForMigration();
+        report("Read (freezing)", adaptive_ms, fixed_ms);
+        // 冻结生效后测得的查询若比冻结前慢，仍会迁回链式表
+        report("Read x3", time_lookups(adaptive, adaptive_keys, 3), time_lookups(fixed, adaptive_keys, 3));
+        adaptive.waitForMigration();
+        report("Read x3 (settled)", time_lookups(adaptive, adaptive_keys, 3), time_lookups(fixed, adaptive_keys, 3));
+        
+        // 写入恢复：写比例超过阈值后迁回动态实现
+        adaptive_ms = time_inserts(adaptive, 1);
+        fixed_ms = time_inserts(fixed, 1);
+        adaptive.waitForMigration();
+        report("Update 200k", adaptive_ms, fixed_ms);
+    }
+
+    // === 布谷鸟散列：高装载率下的尾延迟，对比逐次查找的分位数而不只是平均值 ===
+    cout << "\n=== 布谷鸟散列 (CuckooHash) ===" << endl;
+    {
+        mt19937 cuckoo_rng(39);
+        const size_t cuckoo_slots = size_t(1) << 17;
+        vector<string> cuckoo_keys;
+        for (size_t i = 0; i < cuckoo_slots * 95 / 100; i++) {
+            cuckoo_keys.push_back(random_string(10, cuckoo_rng));
+        }
+        vector<string> absent_keys;
+        for (size_t i = 0; i < cuckoo_keys.size(); i++) {
+            absent_keys.push_back(random_string(11, cuckoo_rng));
+        }
+        CuckooHash cuckoo(cuckoo_slots);
+        ElasticHash elastic(4);
+        FunnelHash funnel;
+        for (size_t i = 0; i < cuckoo_keys.size(); i++) {
+            cuckoo.insert(cuckoo_keys[i], static_cast<int>(i));
+            elastic.insert(cuckoo_keys[i], static_cast<int>(i));
+            funnel.insert(cuckoo_keys[i], static_cast<int>(i));
+        }
+        cout << "CuckooHash: " << cuckoo.size() << " keys in " << cuckoo.getSlotCount() << " slots, load factor "
+             << cuckoo.getLoadFactor() << ", stash " << cuckoo.getStashSize() << ", grows " << cuckoo.getGrowCount() << endl;
+
+        // 逐次计时（包含约几十 ns 的时钟开销），排序后取分位数
+        shuffle(cuckoo_keys.begin(), cuckoo_keys.end(), cuckoo_rng);
+        auto latency = [](const AbstractHash &table, const vector<string> &queries) {
+            vector<long long> ns;
+            ns.reserve(queries.size());
+            int value = 0;
+            for (const auto &key : queries) {
+                auto start = chrono::steady_clock::now();
+                table.tryFind(key, value);
+                auto end = chrono::steady_clock::now();
+                ns.push_back(chrono::duration_cast<chrono::nanoseconds>(end - start).count());
+            }
+            sort(ns.begin(), ns.end());
+            auto at = [&](double q) { return ns[static_cast<size_t>(q * (ns.size() - 1))]; };
+            return to_string(at(0.5)) + "\t" + to_string(at(0.99)) + "\t" + to_string(at(0.999)) + "\t" + to_string(ns.back());
+        };
+        cout << "Table\t\tQueries\tp50(ns)\tp99(ns)\tp99.9(ns)\tmax(ns)" << endl;
+        cout << "CuckooHash\thit\t" << latency(cuckoo, cuckoo_keys) << endl;
+        cout << "CuckooHash\tmiss\t" << latency(cuckoo, absent_keys) << endl;
+        cout << "ElasticHash\thit\t" << latency(elastic, cuckoo_keys) << endl;
+        cout << "ElasticHash\tmiss\t" << latency(elastic, absent_keys) << endl;
+        cout << "FunnelHash\thit\t" << latency(funnel, cuckoo_keys) << endl;
+        cout << "FunnelHash\tmiss\t" << latency(funnel, absent_keys) << endl;
+    }
+
+    // === 负向查找过滤：表前的分块 Bloom filter，按未命中比例对比开/关过滤器的查询开销 ===
+    cout << "\n=== 负向查找过滤 (FilteredHash) ===" << endl;
+    {
+        mt19937 filter_rng(40);
+        vector<string> present_keys, absent_keys;
+        for (int i = 0; i < 200000; i++) {
+            present_keys.push_back(random_string(10, filter_rng));
+            absent_keys.push_back(random_string(11, filter_rng)); // 长度不同，一定不在表中
+        }
+        SimpleHash plain_sh(present_keys.size());
+        ElasticHash plain_eh(4);
+        FilteredHash filtered_sh(make_unique<SimpleHash>(present_keys.size()), present_keys.size());
+        FilteredHash filtered_eh(make_unique<ElasticHash>(4), present_keys.size());
+        for (size_t i = 0; i < present_keys.size(); i++) {
+            plain_sh.insert(present_keys[i], static_cast<int>(i));
+            plain_eh.insert(present_keys[i], static_cast<int>(i));
+            filtered_sh.insert(present_keys[i], static_cast<int>(i));
+            filtered_eh.insert(present_keys[i], static_cast<int>(i));
+        }
+        const BlockedBloomFilter &filter = filtered_sh.getFilter();
+        size_t false_positives = 0;
+        for (const auto &key : absent_keys) {
+            false_positives += filter.mayContain(BlockedBloomFilter::hashKey(key));
+        }
+        cout << "Filter: " << filter.getMemoryBytes() / 1024 << " KB for " << filtered_sh.size()
+             << " keys, false positive rate " << 100.0 * false_positives / absent_keys.size() << "%" << endl;
+
+        auto ns_per_lookup = [](const AbstractHash &table, const vector<string> &queries) {
+            volatile int sum = 0;
+            int value = 0;
+            auto start = chrono::high_resolution_clock::now();
+            for (const auto &key : queries) {
+                if (table.tryFind(key, value))
+                    sum += value;
+            }
+            auto end = chrono::high_resolution_clock::now();
+            return chrono::duration_cast<chrono::nanoseconds>(end - start).count() / static_cast<double>(queries.size());
+        };
+        auto ns_per_batch_lookup = [](const AbstractHash &table, const vector<string> &queries) {
+            vector<int> values(queries.size());
+            unique_ptr<bool[]> found(new bool[queries.size()]);
+            auto start = chrono::high_resolution_clock::now();
+            table.findBatch(queries.data(), queries.size(), values.data(), found.get());
+            auto end = chrono::high_resolution_clock::now();
+            return chrono::duration_cast<chrono::nanoseconds>(end - start).count() / static_cast<double>(queries.size());
+        };
+        // 依次为 SimpleHash、+filter、SimpleHash 批量、+filter 批量、ElasticHash、+filter
+        const char *columns[] = {"SimpleHash", "SimpleHash findBatch", "ElasticHash"};
+        vector<int> miss_percents = {0, 10, 25, 50, 75, 90, 99};
+        vector<array<double, 6>> results;
+        cout << "Miss%\tSimpleHash(ns)\t+filter(ns)\tBatch(ns)\t+filter(ns)\tElasticHash(ns)\t+filter(ns)" << endl;
+        for (int miss_percent : miss_percents) {
+            vector<string> queries;
+            for (size_t i = 0; i < 1000000; i++) {
+                bool miss = static_cast<int>(filter_rng() % 100) < miss_percent;
+                const auto &source = miss ? absent_keys : present_keys;
+                queries.push_back(source[filter_rng() % source.size()]);
+            }
+            array<double, 6> row = {ns_per_lookup(plain_sh, queries), ns_per_lookup(filtered_sh, queries),
+                                    ns_per_batch_lookup(plain_sh, queries), ns_per_batch_lookup(filtered_sh, queries),
+                                    ns_per_lookup(plain_eh, queries), ns_per_lookup(filtered_eh, queries)};
+            results.push_back(row);
+            cout << miss_percent;
+            for (size_t c = 0; c < row.size(); c++) {
+                cout << (c == 0 ? "\t" : "\t\t") << static_cast<long long>(row[c]);
+            }
+            cout << endl;
+        }
+        // 过滤器开始划算的未命中比例：在第一个"加过滤器更快"的测量点与前一个点之间线性插值
+        cout << "Break-even miss%:";
+        for (int c = 0; c < 3; c++) {
+            cout << " " << columns[c] << " ";
+            size_t i = 0;
+            while (i < results.size() && results[i][2 * c + 1] > results[i][2 * c])
+                i++;
+            if (i == results.size()) {
+                cout << ">" << miss_percents.back();
+            } else if (i == 0) {
+                cout << "<=" << miss_percents[0];
+            } else {
+                double before = results[i - 1][2 * c + 1] - results[i - 1][2 * c];
+                double after = results[i][2 * c + 1] - results[i][2 * c];
+                cout << static_cast<int>(miss_percents[i - 1] + (miss_percents[i] - miss_percents[i - 1]) * before / (before - after));
+            }
+            if (c < 2)
+                cout << ";";
+        }
+        cout << endl;
+    }
+
     // 使用最小的测试集执行其他测试
     vector<string>& keys = test_sets[0]; // 使用大小为10的测试集
     
@@ -287,6 +848,23 @@ int main() {
         catch(const std::runtime_error &e) { cout << "Not found" << endl; }
     }
     
+    // 批量删除后的桶合并与目录收缩
+    cout << "\nElasticHash Shrink:" << endl;
+    ElasticHash shrink_eh(4);
+    mt19937 shrink_rng(7);
+    vector<string> shrink_keys;
+    for (int i = 0; i < 5000; i++) {
+        shrink_keys.push_back(random_string(8, shrink_rng));
+        shrink_eh.insert(shrink_keys.back(), i);
+    }
+    cout << "After 5000 inserts: directory " << shrink_eh.getDirectorySize()
+         << ", buckets " << shrink_eh.getBucketCount() << endl;
+    for (int i = 0; i < 4500; i++) {
+        shrink_eh.erase(shrink_keys[i]);
+    }
+    cout << "After erasing 90%: directory " << shrink_eh.getDirectorySize()
+         << ", buckets " << shrink_eh.getBucketCount() << endl;
+
     // FunnelHash（动态散列）
     cout << "\nTesting FunnelHash (dynamic):" << endl;
     FunnelHash fh;
@@ -340,8 +918,8 @@ int main() {
             int probe_count = 1;
             
             // 模拟探测过程记录冲突和探测次数
-            for (const auto& pair : standard_hash.getChainAt(ideal_pos)) {
-                if (pair.first == key) {
+            for (const auto& entry : standard_hash.getChainAt(ideal_pos)) {
+                if (entry.key == key) {
                     break;
                 }
                 collisions++;
@@ -377,42 +955,88 @@ int main() {
     // 准备测试数据
     auto large_dataset = test_sets.back(); // 使用最大的测试集（1000个键）
     
-    // 测试优化前版本
-    SimpleHash baseline_hash(large_dataset.size() * 2);
-    for (const auto& key : large_dataset) {
-        baseline_hash.insert(key, 1);
+    // 自组织链只在访问偏斜、链较长时有意义：Zipfian 查询，负载因子 1 与 4，
+    // 键按随机顺序插入，使热键不会因为先插入而天然位于链头
+    {
+        WorkloadConfig skew_config;
+        skew_config.key_count = 20000;
+        skew_config.operation_count = 1000000;
+        skew_config.distribution = AccessDistribution::Zipfian;
+        skew_config.seed = 38;
+        Workload skewed = Workload::generate(skew_config);
+        vector<string> skew_keys = skewed.getPreloadKeys();
+        shuffle(skew_keys.begin(), skew_keys.end(), mt19937(38));
+        
+        cout << "Zipfian lookups (theta " << skew_config.zipf_theta << ", " << skew_config.operation_count << " ops):" << endl;
+        cout << "Load\tChains\t\t\tAvg Probes\tns/lookup" << endl;
+        for (size_t load : {1, 4}) {
+            for (bool self_organizing : {false, true}) {
+                SimpleHash chained(skew_keys.size() / load, self_organizing);
+                for (const auto &key : skew_keys) {
+                    chained.insert(key, 1);
+                }
+                ReplayResult result = skewed.replay(chained);
+                // 探测次数按查询分布加权，在回放结束后的链顺序上统计
+                long long probes = 0;
+                for (const auto &op : skewed.getOperations()) {
+                    probes += chained.getProbeCount(op.key);
+                }
+                cout << load << "\t" << (self_organizing ? "self-organizing" : "plain\t\t") << "\t"
+                     << static_cast<double>(probes) / skewed.getOperations().size() << "\t\t"
+                     << result.elapsed_ms * 1e6 / skewed.getOperations().size() << endl;
+            }
+        }
     }
     
-    auto baseline_start = chrono::high_resolution_clock::now();
-    volatile int baseline_sum = 0;
-    for (int i = 0; i < 10000; i++) {
+    // 短 key 内联特化：不超过 8 字节的 key 打包进一个机器字
+    cout << "\nInline key specialization (keys <= 8 bytes):" << endl;
+    {
+        SimpleHash sh_str(large_dataset.size() * 2);
+        BasicSimpleHash<InlineKey<8>> sh_inline(large_dataset.size() * 2);
+        ElasticHash eh_str(4);
+        BasicElasticHash<InlineKey<8>> eh_inline(4);
+        FunnelHash fh_str;
+        BasicFunnelHash<InlineKey<8>> fh_inline;
         for (const auto& key : large_dataset) {
-            baseline_sum += baseline_hash.find(key);
+            sh_str.insert(key, 1);
+            sh_inline.insert(key, 1);
+            eh_str.insert(key, 1);
+            eh_inline.insert(key, 1);
+            fh_str.insert(key, 1);
+            fh_inline.insert(key, 1);
         }
-    }
-    auto baseline_end = chrono::high_resolution_clock::now();
-    auto baseline_time = chrono::duration_cast<chrono::milliseconds>(baseline_end - baseline_start).count();
-    
-    // 测试使用论文优化的版本（需要在SimpleHash中添加优化选项）
-    SimpleHash optimized_hash(large_dataset.size() * 2, true); // 添加参数启用论文优化
-    for (const auto& key : large_dataset) {
-        optimized_hash.insert(key, 1);
-    }
-    
-    auto optimized_start = chrono::high_resolution_clock::now();
-    volatile int optimized_sum = 0;
-    for (int i = 0; i < 10000; i++) {
+        cout << "Table\t\tstd::string(ms)\tInlineKey<8>(ms)" << endl;
+        cout << "SimpleHash\t" << time_lookups(sh_str, large_dataset, 10000)
+             << "\t\t" << time_lookups(sh_inline, large_dataset, 10000) << endl;
+        cout << "ElasticHash\t" << time_lookups(eh_str, large_dataset, 10000)
+             << "\t\t" << time_lookups(eh_inline, large_dataset, 10000) << endl;
+        cout << "FunnelHash\t" << time_lookups(fh_str, large_dataset, 10000)
+             << "\t\t" << time_lookups(fh_inline, large_dataset, 10000) << endl;
+        
+        // MPH 输入路径：预先打包的 key 跳过 string 转换
+        MinimalPerfectHash inline_mph(large_dataset);
+        vector<InlineKey<8>> packed_keys;
         for (const auto& key : large_dataset) {
-            optimized_sum += optimized_hash.find(key);
+            packed_keys.push_back(InlineKey<8>(key));
         }
+        auto mph_str_start = chrono::high_resolution_clock::now();
+        volatile int mph_str_sum = 0;
+        for (int i = 0; i < 10000; i++) {
+            for (const auto& key : large_dataset) {
+                mph_str_sum += inline_mph.hash(key);
+            }
+        }
+        auto mph_str_end = chrono::high_resolution_clock::now();
+        volatile int mph_inline_sum = 0;
+        for (int i = 0; i < 10000; i++) {
+            for (const auto& key : packed_keys) {
+                mph_inline_sum += inline_mph.hash(key);
+            }
+        }
+        auto mph_inline_end = chrono::high_resolution_clock::now();
+        cout << "MPH\t\t" << chrono::duration_cast<chrono::milliseconds>(mph_str_end - mph_str_start).count()
+             << "\t\t" << chrono::duration_cast<chrono::milliseconds>(mph_inline_end - mph_str_end).count() << endl;
     }
-    auto optimized_end = chrono::high_resolution_clock::now();
-    auto optimized_time = chrono::duration_cast<chrono::milliseconds>(optimized_end - optimized_start).count();
-    
-    // 输出优化效果
-    cout << "Baseline implementation: " << baseline_time << " ms" << endl;
-    cout << "Optimized implementation: " << optimized_time << " ms" << endl;
-    cout << "Performance improvement: " << (baseline_time - optimized_time) * 100.0 / baseline_time << "%" << endl;
     
     // 4. 论文中最佳界限(optimal bounds)验证
     cout << "\nValidating optimal bounds from paper:" << endl;
@@ -1,14 +1,14 @@
 #include "mph.hpp"
-#include <cstdlib>
-#include <ctime>
+#include <random>
 #include <queue>       // 可保留，实际不再使用
 #include <vector>
 #include <iostream>
 #include <chrono>
+#include <cstring>
 
 // MinimalPerfectHash 构造函数及接口实现
-MinimalPerfectHash::MinimalPerfectHash(const vector<string>& keys)
-    : keys(keys), n(keys.size()) {
+MinimalPerfectHash::MinimalPerfectHash(vector<string> input_keys, bool allow_fallback)
+    : keys(std::move(input_keys)), n(keys.size()), fallback(false) {
     // Use a much larger m for better acyclic graph probability
     m = static_cast<int>(keys.size() * 3.0);
     
@@ -28,7 +28,8 @@ MinimalPerfectHash::MinimalPerfectHash(const vector<string>& keys)
     };
     
     bool success = false;
-    srand((unsigned)time(0));
+    // 每个实例自带随机数生成器：后台线程里构造 MPH 时不读写全局 rand() 状态
+    mt19937 rng(static_cast<uint32_t>(chrono::steady_clock::now().time_since_epoch().count()) ^ static_cast<uint32_t>(n));
     
     // Use multiple strategies to try to construct the MPH
     for (int strategy = 0; strategy < 3 && !success; strategy++) {
@@ -48,13 +49,13 @@ MinimalPerfectHash::MinimalPerfectHash(const vector<string>& keys)
                 seed2 = seed_pool[(attempt + 1) % seed_pool.size()];
             } else if (strategy == 2) {
                 // Strategy 3: Completely random seeds
-                seed1 = rand() ^ (rand() << 15);
-                seed2 = rand() ^ (rand() << 15);
+                seed1 = rng();
+                seed2 = rng();
             } else {
                 // Mix strategies
                 if (attempt % 3 == 0) {
-                    seed1 = rand() ^ (rand() << 15);
-                    seed2 = rand() ^ (rand() << 15);
+                    seed1 = rng();
+                    seed2 = rng();
                 } else {
                     seed1 = seed_pool[attempt % seed_pool.size()];
                     seed2 = seed_pool[(attempt + seed_pool.size()/2) % seed_pool.size()];
@@ -73,6 +74,8 @@ MinimalPerfectHash::MinimalPerfectHash(const vector<string>& keys)
     construction_time = chrono::duration_cast<chrono::milliseconds>(end_time - start_time).count();
     
     if (!success) {
+        if (!allow_fallback)
+            throw runtime_error("Failed to construct MinimalPerfectHash for " + to_string(n) + " keys");
         // Instead of throwing an exception, we'll use a fallback method
         // We'll assign each key a unique value in [0, n-1] based on its position in the keys vector
         // This ensures that we at least have a functioning (though not perfect) hash
@@ -80,6 +83,7 @@ MinimalPerfectHash::MinimalPerfectHash(const vector<string>& keys)
         g.assign(m, 0);
         seed1 = 12345;
         seed2 = 67890;
+        fallback = true;
         cout << "Warning: Using fallback hash implementation (not MPH) for " << n << " keys" << endl;
     }
 }
@@ -93,10 +97,12 @@ bool MinimalPerfectHash::construct() {
     for (int i = 0; i < n; i++) {
         int u = computeHash(keys[i], seed1) % m;
         int v = computeHash(keys[i], seed2) % m;
+        // 自环无法满足 (g[u] + g[u]) mod n == i，换一组种子重试
+        if (u == v)
+            return false;
         edges.push_back({i, u, v});
         adj[u].push_back(i);
-        if (u != v)
-            adj[v].push_back(i);
+        adj[v].push_back(i);
     }
     // 优化：直接使用度数表，跳过度数为0的顶点
     vector<int> deg(m, 0);
@@ -118,20 +124,19 @@ bool MinimalPerfectHash::construct() {
             }
         }
     }
-    // 优化的压缩和赋值过程
+    // 记录消除顺序：(顶点, 边编号)，该边由此顶点"认领"
+    vector<pair<int, int>> order;
+    order.reserve(n);
+    // 优化的压缩过程
     while (!stack.empty()) {
         // 修复C++11不支持结构化绑定的问题
         pair<int, int> stack_item = stack.back();
         int v = stack_item.first;
         int e_id = stack_item.second;
         stack.pop_back();
+        order.push_back(stack_item);
         const auto &edge = edges[e_id];
         int u = (edge.u == v) ? edge.v : edge.u;
-        // 根据论文：设置 g[v] 使得 (g[u] + g[v]) mod n 等于 key_index
-        int value = (edge.key_index - g[u]) % n;
-        if (value < 0)
-            value += n;
-        g[v] = value;
         // 更新相邻顶点 u 的度数
         deg[u]--;
         if (deg[u] == 1) {
@@ -149,12 +154,24 @@ bool MinimalPerfectHash::construct() {
         if (!flag)
             return false;
     }
+    // 按消除顺序的逆序赋值：处理 (v, e) 时 v 之后不会再被赋值，
+    // 而 u 上更晚消除的边都已处理完，g[u] 已是最终值。
+    // 根据论文：设置 g[v] 使得 (g[u] + g[v]) mod n 等于 key_index
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        int v = it->first;
+        const auto &edge = edges[it->second];
+        int u = (edge.u == v) ? edge.v : edge.u;
+        int value = (edge.key_index - g[u]) % n;
+        if (value < 0)
+            value += n;
+        g[v] = value;
+    }
     return true;
 }
 
 int MinimalPerfectHash::hash(const string &key) const {
     // If we're using the fallback implementation, do a simple hash to get a value in range
-    if (m == n && g[0] == 0 && n > 0) {
+    if (fallback) {
         uint32_t h = computeHash(key, seed1);
         for (size_t i = 0; i < keys.size(); i++) {
             if (keys[i] == key) return i;
@@ -183,9 +200,25 @@ int MinimalPerfectHash::encapsulatedHash(const string &key) const {
 }
 
 uint32_t MinimalPerfectHash::computeHash(const string &key, uint32_t seed) {
-    uint32_t h = seed;
-    for (char c : key) {
-        h = h * 31 + static_cast<unsigned char>(c);
+    // 不超过 16 字节的短 key 按两个机器字求 hash，避免逐字节循环
+    InlineKey<16> packed = InlineKey<16>::pack(key);
+    if (packed.valid())
+        return computeHash(packed.lo(), packed.hi(), seed);
+    // 长 key 按 16 字节分块链式混合，种子参与每一步：
+    // 不同种子下的 hash 差值随 key 变化，两个顶点才相互独立
+    uint64_t h = seed ^ key.size();
+    size_t i = 0;
+    for (; i + 16 <= key.size(); i += 16) {
+        uint64_t lo, hi;
+        memcpy(&lo, key.data() + i, sizeof(lo));
+        memcpy(&hi, key.data() + i + 8, sizeof(hi));
+        h = hashWords(lo, hi, h);
     }
-    return h;
-}
\ No newline at end of file
+    uint64_t tail[2] = {0, 0};
+    memcpy(tail, key.data() + i, key.size() - i);
+    return static_cast<uint32_t>(hashWords(tail[0], tail[1], h ^ seed));
+}
+
+uint32_t MinimalPerfectHash::computeHash(uint64_t lo, uint64_t hi, uint32_t seed) {
+    return static_cast<uint32_t>(hashWords(lo, hi, seed));
+}
@@ -4,6 +4,7 @@
 #include <vector>
 #include <string>
 #include <stdexcept>
+#include "hash_key.hpp"
 using namespace std;
 
 // 用于构造静态最优无冲突 hash 的辅助结构
@@ -16,12 +17,23 @@ struct Edge {
 // 采用基于栈的消除法来构造 acyclic 图，从而生成 minimal perfect hash 函数。
 class MinimalPerfectHash {
 public:
-    // 构造时传入静态键集，生成 minimal perfect hash
-    MinimalPerfectHash(const vector<string>& keys);
+    // 构造时传入静态键集，生成 minimal perfect hash；键集中第 i 个键的 hash 值为 i。
+    // 所有种子都失败时 allow_fallback 为 true 则退化为线性查找（并打印警告），否则抛出异常
+    MinimalPerfectHash(vector<string> keys, bool allow_fallback = true);
     
     // 返回 key 对应的 hash 值（范围 [0, n-1]）
     int hash(const string& key) const;
     
+    // 短 key 特化的输入路径：直接对打包后的机器字求 hash，与 string 版本结果一致
+    template <size_t N>
+    int hash(const InlineKey<N>& key) const {
+        if (fallback)
+            return hash(key.str());
+        int h1 = computeHash(key.lo(), key.hi(), seed1) % m;
+        int h2 = computeHash(key.lo(), key.hi(), seed2) % m;
+        return (g[h1] + g[h2]) % n;
+    }
+    
     // 封装操作：分别计算 h1 与 h2，用于对比验证
     int computeH1(const string &key) const;
     int computeH2(const string &key) const;
@@ -30,15 +42,24 @@ public:
     // Get construction time in milliseconds
     long long getConstructionTimeMs() const { return construction_time; }
     
+    // 是否退化为线性查找（不是真正的 MPH）
+    bool usesFallback() const { return fallback; }
+    
+    // 构造时保存的键集，keyAt(hash(k)) == k 说明 k 在键集中
+    size_t size() const { return keys.size(); }
+    const string &keyAt(size_t index) const { return keys[index]; }
+    
 private:
     vector<string> keys;
     int n, m;
     vector<int> g;
     uint32_t seed1, seed2;
     long long construction_time; // Add field to track construction time
+    bool fallback;
     
     bool construct();
     static uint32_t computeHash(const string &key, uint32_t seed);
+    static uint32_t computeHash(uint64_t lo, uint64_t hi, uint32_t seed);
 };
 
 #endif // MPH_HPP
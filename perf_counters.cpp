@@ -0,0 +1,127 @@
+#include "perf_counters.hpp"
+#include <sstream>
+#include <cstring>
+#include <cstdint>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+#ifdef __linux__
+int openEvent(uint32_t type, uint64_t config) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+uint64_t cacheMiss(uint64_t cache) {
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+#endif
+
+} // namespace
+
+PerfCounters::PerfCounters() {
+    for (int i = 0; i < PERF_EVENT_COUNT; i++) {
+        fds[i] = -1;
+    }
+#ifdef __linux__
+    fds[PERF_CYCLES] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    fds[PERF_INSTRUCTIONS] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    fds[PERF_L1D_MISSES] = openEvent(PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_L1D));
+    fds[PERF_LLC_MISSES] = openEvent(PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_LL));
+    fds[PERF_DTLB_MISSES] = openEvent(PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_DTLB));
+    fds[PERF_BRANCH_MISSES] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+    for (int i = 0; i < PERF_EVENT_COUNT; i++) {
+        if (fds[i] >= 0)
+            close(fds[i]);
+    }
+#endif
+}
+
+bool PerfCounters::available() const {
+    for (int i = 0; i < PERF_EVENT_COUNT; i++) {
+        if (fds[i] >= 0)
+            return true;
+    }
+    return false;
+}
+
+void PerfCounters::start() {
+#ifdef __linux__
+    for (int i = 0; i < PERF_EVENT_COUNT; i++) {
+        if (fds[i] >= 0) {
+            ioctl(fds[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(fds[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#endif
+}
+
+PerfSample PerfCounters::stop() {
+    PerfSample sample;
+    for (int i = 0; i < PERF_EVENT_COUNT; i++) {
+        sample.values[i] = 0;
+        sample.valid[i] = false;
+    }
+#ifdef __linux__
+    for (int i = 0; i < PERF_EVENT_COUNT; i++) {
+        if (fds[i] >= 0)
+            ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+    }
+    for (int i = 0; i < PERF_EVENT_COUNT; i++) {
+        if (fds[i] < 0)
+            continue;
+        // {value, time_enabled, time_running}；计数器被复用时按运行时间比例放大
+        uint64_t data[3];
+        if (read(fds[i], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) || data[2] == 0)
+            continue;
+        double scale = static_cast<double>(data[1]) / data[2];
+        sample.values[i] = static_cast<long long>(data[0] * scale);
+        sample.valid[i] = true;
+    }
+#endif
+    return sample;
+}
+
+const char *PerfCounters::eventName(int event) {
+    static const char *names[PERF_EVENT_COUNT] = {
+        "cycles", "instructions", "l1d_misses", "llc_misses", "dtlb_misses", "branch_misses"
+    };
+    return names[event];
+}
+
+std::string PerfCounters::csvHeader(const std::string &prefix) {
+    std::ostringstream out;
+    for (int i = 0; i < PERF_EVENT_COUNT; i++) {
+        out << "," << prefix << "_" << eventName(i) << "_per_op";
+    }
+    return out.str();
+}
+
+std::string PerfCounters::csvFields(const PerfSample &sample, long long ops) {
+    std::ostringstream out;
+    for (int i = 0; i < PERF_EVENT_COUNT; i++) {
+        out << ",";
+        if (sample.valid[i] && ops > 0)
+            out << static_cast<double>(sample.values[i]) / ops;
+    }
+    return out.str();
+}
@@ -0,0 +1,49 @@
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+
+#include <string>
+
+// 基准测试用的硬件性能计数器（Linux perf_event_open）。
+// 每个事件独立打开，某个事件不受支持（虚拟机、权限、非 Linux）时只跳过该事件，
+// 其余计数照常工作；全部不可用时 available() 为 false，输出留空。
+
+enum PerfEvent {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_L1D_MISSES,
+    PERF_LLC_MISSES,
+    PERF_DTLB_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_EVENT_COUNT
+};
+
+struct PerfSample {
+    long long values[PERF_EVENT_COUNT];
+    bool valid[PERF_EVENT_COUNT];
+};
+
+class PerfCounters {
+public:
+    PerfCounters();
+    ~PerfCounters();
+    
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+    
+    bool available() const;
+    
+    // 计数区间：start() 清零并开始计数，stop() 停止并返回（按复用比例缩放后的）计数
+    void start();
+    PerfSample stop();
+    
+    static const char *eventName(int event);
+    
+    // CSV 列：<prefix>_<event>_per_op，计数不可用的列输出为空
+    static std::string csvHeader(const std::string &prefix);
+    static std::string csvFields(const PerfSample &sample, long long ops);
+    
+private:
+    int fds[PERF_EVENT_COUNT];
+};
+
+#endif // PERF_COUNTERS_HPP
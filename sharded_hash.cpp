@@ -0,0 +1,104 @@
+#include "sharded_hash.hpp"
+#include <mutex>
+
+template <class Key>
+BasicShardedSimpleHash<Key>::BasicShardedSimpleHash(size_t capacity, size_t shard_count)
+    : shard_count(1), shard_bits(0) {
+    while (this->shard_count < shard_count) {
+        this->shard_count <<= 1;
+        shard_bits++;
+    }
+    size_t shard_capacity = capacity / this->shard_count;
+    if (shard_capacity == 0)
+        shard_capacity = 1;
+    shards.reset(new Shard[this->shard_count]);
+    for (size_t i = 0; i < this->shard_count; i++) {
+        shards[i].table = BasicSimpleHash<Key>(shard_capacity);
+    }
+}
+
+// 分段由 hash 乘法散列后的高位决定，与分段内按 hash % capacity 选链相互独立
+template <class Key>
+typename BasicShardedSimpleHash<Key>::Shard &BasicShardedSimpleHash<Key>::shardFor(size_t hash) const {
+    if (shard_bits == 0)
+        return shards[0];
+    uint64_t mixed = static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ULL;
+    return shards[mixed >> (64 - shard_bits)];
+}
+
+template <class Key>
+void BasicShardedSimpleHash<Key>::insert(const std::string &key, int value) {
+    if (!KeyTraits<Key>::fits(key))
+        throw std::length_error("Key does not fit in ShardedSimpleHash key type");
+    const auto &k = KeyTraits<Key>::from(key);
+    size_t hash = KeyTraits<Key>::hash(k);
+    Shard &shard = shardFor(hash);
+    std::unique_lock<std::shared_mutex> guard(shard.lock);
+    shard.table.insertHashed(k, hash, value);
+}
+
+template <class Key>
+void BasicShardedSimpleHash<Key>::erase(const std::string &key) {
+    const auto &k = KeyTraits<Key>::from(key);
+    size_t hash = KeyTraits<Key>::hash(k);
+    Shard &shard = shardFor(hash);
+    bool erased;
+    {
+        std::unique_lock<std::shared_mutex> guard(shard.lock);
+        erased = shard.table.eraseHashed(k, hash);
+    }
+    if (!erased)
+        throw std::runtime_error("Key not found in ShardedSimpleHash");
+}
+
+template <class Key>
+int BasicShardedSimpleHash<Key>::find(const std::string &key) const {
+    const auto &k = KeyTraits<Key>::from(key);
+    size_t hash = KeyTraits<Key>::hash(k);
+    Shard &shard = shardFor(hash);
+    int value;
+    {
+        std::shared_lock<std::shared_mutex> guard(shard.lock);
+        const int *found = shard.table.findHashed(k, hash);
+        if (!found)
+            throw std::runtime_error("Key not found in ShardedSimpleHash");
+        value = *found;
+    }
+    return value;
+}
+
+// 直接判断是否命中，避免默认实现中未命中时的异常开销
+template <class Key>
+bool BasicShardedSimpleHash<Key>::tryFind(const std::string &key, int &value) const {
+    const auto &k = KeyTraits<Key>::from(key);
+    size_t hash = KeyTraits<Key>::hash(k);
+    Shard &shard = shardFor(hash);
+    std::shared_lock<std::shared_mutex> guard(shard.lock);
+    const int *found = shard.table.findHashed(k, hash);
+    if (!found)
+        return false;
+    value = *found;
+    return true;
+}
+
+template <class Key>
+void BasicShardedSimpleHash<Key>::forEach(const EntryVisitor &visit) const {
+    for (size_t i = 0; i < shard_count; i++) {
+        std::shared_lock<std::shared_mutex> guard(shards[i].lock);
+        shards[i].table.forEach(visit);
+    }
+}
+
+template <class Key>
+void BasicShardedSimpleHash<Key>::parallelForEach(const EntryVisitor &visit, unsigned threads) const {
+    forEachRange(shard_count, threads, [this, &visit](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            std::shared_lock<std::shared_mutex> guard(shards[i].lock);
+            shards[i].table.forEach(visit);
+        }
+    });
+}
+
+template class BasicShardedSimpleHash<std::string>;
+template class BasicShardedSimpleHash<InlineKey<8>>;
+template class BasicShardedSimpleHash<InlineKey<16>>;
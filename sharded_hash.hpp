@@ -0,0 +1,53 @@
+#ifndef SHARDED_HASH_HPP
+#define SHARDED_HASH_HPP
+
+#include "abstract_hash.hpp"
+#include "simple_hash.hpp"
+#include <string>
+#include <memory>
+#include <shared_mutex>
+
+// BasicShardedSimpleHash 是可多线程并发读写的链地址散列表：
+// 按 hash 高位把键分到 2 的幂个独立加锁的 BasicSimpleHash 分段中，
+// 查询持有分段的读锁，插入/删除持有写锁，不同分段的写操作互不阻塞
+template <class Key>
+class BasicShardedSimpleHash : public AbstractHash {
+public:
+    // capacity 为所有分段的链数之和；shard_count 向上取整为 2 的幂
+    BasicShardedSimpleHash(size_t capacity = 1024, size_t shard_count = 64);
+    
+    void insert(const std::string &key, int value) override;
+    void erase(const std::string &key) override;
+    int find(const std::string &key) const override;
+    bool tryFind(const std::string &key, int &value) const override;
+    
+    // 逐个分段持有读锁遍历，不提供迭代器：跨分段的迭代器无法在并发写入下保持有效。
+    // 遍历期间其他线程可以写入尚未扫描或已扫描完的分段，结果不是全表快照
+    void forEach(const EntryVisitor &visit) const override;
+    // 分段本身就是切分单位，每个线程负责一段连续的分段
+    void parallelForEach(const EntryVisitor &visit, unsigned threads = 0) const override;
+    
+    size_t getShardCount() const { return shard_count; }
+    
+private:
+    // 每个分段独占缓存行，避免相邻分段的锁产生伪共享
+    struct alignas(64) Shard {
+        mutable std::shared_mutex lock;
+        BasicSimpleHash<Key> table;
+    };
+    
+    std::unique_ptr<Shard[]> shards;
+    size_t shard_count;
+    int shard_bits;
+    
+    Shard &shardFor(size_t hash) const;
+};
+
+using ShardedSimpleHash = BasicShardedSimpleHash<std::string>;
+
+// 实现位于 sharded_hash.cpp，仅显式实例化以下 key 类型
+extern template class BasicShardedSimpleHash<std::string>;
+extern template class BasicShardedSimpleHash<InlineKey<8>>;
+extern template class BasicShardedSimpleHash<InlineKey<16>>;
+
+#endif // SHARDED_HASH_HPP
@@ -1,66 +1,253 @@
 #include "simple_hash.hpp"
 #include <functional>
+#include <algorithm>
 
-SimpleHash::SimpleHash(size_t capacity, bool use_paper_optimization)
+namespace {
+
+// 命中计数的上限；达到后整条链的计数减半（老化），
+// 每条链每 kHitCountLimit / 2 次命中才摊到一次 O(链长) 的减半
+const uint32_t kHitCountLimit = 1u << 16;
+
+} // namespace
+
+template <class Key>
+BasicSimpleHash<Key>::BasicSimpleHash(size_t capacity, bool use_paper_optimization)
     : capacity(capacity), use_optimization(use_paper_optimization) {
     table.resize(capacity);
+    if (use_optimization)
+        hit_counts.resize(capacity);
+}
+
+template <class Key>
+size_t BasicSimpleHash<Key>::hashKey(const std::string &key) const {
+    return KeyTraits<Key>::hash(KeyTraits<Key>::from(key)) % capacity;
 }
 
-size_t SimpleHash::hashKey(const std::string &key) const {
-    return std::hash<std::string>{}(key) % capacity;
+template <class Key>
+void BasicSimpleHash<Key>::insert(const std::string &key, int value) {
+    if (!KeyTraits<Key>::fits(key))
+        throw std::length_error("Key does not fit in SimpleHash key type");
+    const auto &k = KeyTraits<Key>::from(key);
+    insertHashed(k, KeyTraits<Key>::hash(k), value);
 }
 
-void SimpleHash::insert(const std::string &key, int value) {
-    size_t idx = hashKey(key);
-    for (auto &pair : table[idx]) {
-        if (pair.first == key) {
-            pair.second = value;
+template <class Key>
+void BasicSimpleHash<Key>::erase(const std::string &key) {
+    const auto &k = KeyTraits<Key>::from(key);
+    if (!eraseHashed(k, KeyTraits<Key>::hash(k)))
+        throw std::runtime_error("Key not found in erase");
+}
+
+template <class Key>
+int BasicSimpleHash<Key>::find(const std::string &key) const {
+    const auto &k = KeyTraits<Key>::from(key);
+    const int *value = findHashed(k, KeyTraits<Key>::hash(k));
+    if (!value)
+        throw std::runtime_error("Key not found in find");
+    return *value;
+}
+
+template <class Key>
+bool BasicSimpleHash<Key>::tryFind(const std::string &key, int &value) const {
+    const auto &k = KeyTraits<Key>::from(key);
+    const int *found = findHashed(k, KeyTraits<Key>::hash(k));
+    if (!found)
+        return false;
+    value = *found;
+    return true;
+}
+
+template <class Key>
+bool BasicSimpleHash<Key>::tryFindHashed(const std::string &key, size_t string_hash, int &value) const {
+    const auto &k = KeyTraits<Key>::from(key);
+    const int *found = findHashed(k, KeyTraits<Key>::hash(k, string_hash));
+    if (!found)
+        return false;
+    value = *found;
+    return true;
+}
+
+template <class Key>
+void BasicSimpleHash<Key>::insertHashed(const Key &key, size_t hash, int value) {
+    size_t idx = hash % capacity;
+    for (auto &entry : table[idx]) {
+        if (entry.matches(hash, key)) {
+            entry.value = value;
             return;
         }
     }
     
-    // 使用论文中的优化策略，在插入时优化链表排序
-    if (use_optimization && !table[idx].empty()) {
-        // 根据访问频率优化排序（简化版本）
-        table[idx].insert(table[idx].begin(), {key, value});
-    } else {
-        table[idx].push_back({key, value});
+    // 新键命中次数为 0，追加在链尾不破坏按次数降序的排列
+    table[idx].push_back({key, value, hash});
+    if (use_optimization)
+        hit_counts[idx].push_back(0);
+}
+
+// 记录 table[idx][pos] 的一次命中，返回该表项的新位置。
+// 链始终按命中次数降序（相等的次数相邻）：计数加一后，前面比它小的只可能是
+// 一段次数等于原值的表项，与这一段的第一个交换即可恢复有序
+template <class Key>
+size_t BasicSimpleHash<Key>::recordHit(size_t idx, size_t pos) const {
+    auto &counts = hit_counts[idx];
+    if (++counts[pos] >= kHitCountLimit) {
+        for (auto &count : counts) {
+            count >>= 1;
+        }
+    }
+    size_t target = pos;
+    while (target > 0 && counts[target - 1] < counts[pos]) {
+        target--;
     }
+    if (target != pos) {
+        std::swap(table[idx][pos], table[idx][target]);
+        std::swap(counts[pos], counts[target]);
+    }
+    return target;
 }
 
-void SimpleHash::erase(const std::string &key) {
-    size_t idx = hashKey(key);
+template <class Key>
+bool BasicSimpleHash<Key>::eraseHashed(const Key &key, size_t hash) {
+    size_t idx = hash % capacity;
     for (auto it = table[idx].begin(); it != table[idx].end(); ++it) {
-        if (it->first == key) {
+        if (it->matches(hash, key)) {
+            if (use_optimization)
+                hit_counts[idx].erase(hit_counts[idx].begin() + (it - table[idx].begin()));
             table[idx].erase(it);
-            return;
+            return true;
         }
     }
-    throw std::runtime_error("Key not found in erase");
+    return false;
 }
 
-int SimpleHash::find(const std::string &key) const {
-    size_t idx = hashKey(key);
-    for (const auto &pair : table[idx]) {
-        if (pair.first == key) {
-            return pair.second;
+template <class Key>
+const int *BasicSimpleHash<Key>::findHashed(const Key &key, size_t hash) const {
+    size_t idx = hash % capacity;
+    const auto &chain = table[idx];
+    for (size_t pos = 0; pos < chain.size(); pos++) {
+        if (chain[pos].matches(hash, key)) {
+            if (use_optimization)
+                pos = recordHit(idx, pos);
+            return &chain[pos].value;
         }
     }
-    throw std::runtime_error("Key not found in find");
+    return nullptr;
+}
+
+// AMAC（Asynchronous Memory Access Chaining）：每个在途查找是一个小状态机，
+// 依次经过 链头 -> 链中表项 -> key 字符串 三跳，每跳只发预取就让出，
+// 轮到它时数据大概率已在缓存中，从而把多次依赖的缓存未命中重叠起来
+template <class Key>
+size_t BasicSimpleHash<Key>::findBatch(const std::string *keys, size_t count, int *values, bool *found,
+                                       size_t group_size) const {
+    return findBatchLoop([keys](size_t i) -> const std::string & { return keys[i]; }, nullptr,
+                         count, values, found, group_size);
+}
+
+template <class Key>
+size_t BasicSimpleHash<Key>::findBatchHashed(const std::string *const *keys, const size_t *string_hashes, size_t count,
+                                             int *values, bool *found, size_t group_size) const {
+    return findBatchLoop([keys](size_t i) -> const std::string & { return *keys[i]; }, string_hashes,
+                         count, values, found, group_size);
+}
+
+// string_hashes 为空时在 HASH 阶段逐个计算
+template <class Key>
+template <class KeyAt>
+size_t BasicSimpleHash<Key>::findBatchLoop(KeyAt key_at, const size_t *string_hashes, size_t count,
+                                           int *values, bool *found, size_t group_size) const {
+    enum Stage { HASH, CHAIN, SCAN, COMPARE, IDLE };
+    struct Slot {
+        size_t index;
+        size_t hash;
+        const Entry *pos;
+        const Entry *end;
+        Stage stage;
+    };
+    
+    if (group_size == 0)
+        group_size = 1;
+    std::vector<Slot> slots(std::min(group_size, count));
+    size_t next = 0, hits = 0, active = slots.size();
+    for (auto &slot : slots) {
+        slot.index = next++;
+        slot.stage = HASH;
+    }
+    
+    while (active > 0) {
+        for (auto &slot : slots) {
+            const Entry *hit = nullptr;
+            switch (slot.stage) {
+            case HASH:
+                if (string_hashes)
+                    slot.hash = KeyTraits<Key>::hash(KeyTraits<Key>::from(key_at(slot.index)), string_hashes[slot.index]);
+                else
+                    slot.hash = KeyTraits<Key>::hash(KeyTraits<Key>::from(key_at(slot.index)));
+                prefetchAddress(&table[slot.hash % capacity]);
+                slot.stage = CHAIN;
+                continue;
+            case CHAIN: {
+                const auto &chain = table[slot.hash % capacity];
+                slot.pos = chain.data();
+                slot.end = slot.pos + chain.size();
+                prefetchAddress(slot.pos);
+                slot.stage = SCAN;
+                continue;
+            }
+            case SCAN:
+                while (slot.pos != slot.end && !slot.pos->hashMatches(slot.hash))
+                    ++slot.pos;
+                if (slot.pos != slot.end) {
+                    prefetchAddress(KeyTraits<Key>::address(slot.pos->key));
+                    slot.stage = COMPARE;
+                    continue;
+                }
+                break;
+            case COMPARE:
+                if (slot.pos->key == KeyTraits<Key>::from(key_at(slot.index))) {
+                    hit = slot.pos;
+                    break;
+                }
+                ++slot.pos;
+                slot.stage = SCAN;
+                continue;
+            case IDLE:
+                continue;
+            }
+            
+            // 当前查找结束，写回结果并在该槽位启动下一个查找
+            found[slot.index] = hit != nullptr;
+            if (hit) {
+                values[slot.index] = hit->value;
+                hits++;
+            }
+            if (next < count) {
+                slot.index = next++;
+                slot.stage = HASH;
+            } else {
+                slot.stage = IDLE;
+                active--;
+            }
+        }
+    }
+    return hits;
 }
 
 // 新增方法实现
 
-const std::vector<std::pair<std::string, int>>& SimpleHash::getChainAt(size_t idx) const {
+template <class Key>
+const std::vector<typename BasicSimpleHash<Key>::Entry>& BasicSimpleHash<Key>::getChainAt(size_t idx) const {
     return table[idx];
 }
 
-int SimpleHash::getProbeCount(const std::string &key) const {
-    size_t idx = hashKey(key);
+template <class Key>
+int BasicSimpleHash<Key>::getProbeCount(const std::string &key) const {
     int probes = 1;
+    const auto &k = KeyTraits<Key>::from(key);
+    size_t hash = KeyTraits<Key>::hash(k);
+    size_t idx = hash % capacity;
     
-    for (const auto &pair : table[idx]) {
-        if (pair.first == key) {
+    for (const auto &entry : table[idx]) {
+        if (entry.matches(hash, k)) {
             return probes;
         }
         probes++;
@@ -68,3 +255,25 @@ int SimpleHash::getProbeCount(const std::string &key) const {
     
     return probes;
 }
+
+template <class Key>
+void BasicSimpleHash<Key>::forEach(const EntryVisitor &visit) const {
+    for (const auto &entry : *this) {
+        visit(KeyTraits<Key>::str(entry.key), entry.value);
+    }
+}
+
+template <class Key>
+void BasicSimpleHash<Key>::parallelForEach(const EntryVisitor &visit, unsigned threads) const {
+    forEachRange(table.size(), threads, [this, &visit](size_t begin, size_t end) {
+        for (size_t idx = begin; idx < end; idx++) {
+            for (const auto &entry : table[idx]) {
+                visit(KeyTraits<Key>::str(entry.key), entry.value);
+            }
+        }
+    });
+}
+
+template class BasicSimpleHash<std::string>;
+template class BasicSimpleHash<InlineKey<8>>;
+template class BasicSimpleHash<InlineKey<16>>;
@@ -2,33 +2,122 @@
 #define SIMPLE_HASH_HPP
 
 #include "abstract_hash.hpp"
+#include "hash_key.hpp"
 #include <string>
 #include <vector>
 #include <stdexcept>
+#include <iterator>
 
-// SimpleHash 实现传统的散列表，使用链地址法解决冲突
-class SimpleHash : public AbstractHash {
+// BasicSimpleHash 实现传统的散列表，使用链地址法解决冲突；
+// Key 为 std::string 或短 key 特化 InlineKey<8>/InlineKey<16>
+template <class Key>
+class BasicSimpleHash : public AbstractHash {
 public:
-    SimpleHash(size_t capacity = 101, bool use_paper_optimization = false);
+    using Entry = BasicHashEntry<Key>;
+    
+    // use_paper_optimization 开启自组织链：每个表项记录命中次数，链始终按次数降序排列，
+    // 查找命中后越过前面所有次数相同的表项（与其中第一个交换，每次查找至多交换一次），
+    // 热键逐渐移到链头。该模式下查找会修改链，不能被多个线程同时查找
+    BasicSimpleHash(size_t capacity = 101, bool use_paper_optimization = false);
     
     // 修改方法名称以匹配 AbstractHash 接口
     void insert(const std::string &key, int value) override;
     void erase(const std::string &key) override;
     int find(const std::string &key) const override;
+    bool tryFind(const std::string &key, int &value) const override;
+    
+    // 已知完整 hash 时的操作，供分片等外层结构复用，避免重复计算 hash；
+    // 未命中时返回 false / nullptr 而不抛异常
+    void insertHashed(const Key &key, size_t hash, int value);
+    bool eraseHashed(const Key &key, size_t hash);
+    const int *findHashed(const Key &key, size_t hash) const;
+    
+    // AMAC 批量查找：交错推进 group_size 个查找，每一跳先预取再切换到下一个查找；
+    // 自组织模式下批量查找不调整链内顺序
+    size_t findBatch(const std::string *keys, size_t count, int *values, bool *found,
+                     size_t group_size = 8) const override;
+    
+    // 复用调用方算好的 std::hash；InlineKey 特化的 hash 不同，忽略传入值
+    bool tryFindHashed(const std::string &key, size_t string_hash, int &value) const override;
+    size_t findBatchHashed(const std::string *const *keys, const size_t *string_hashes, size_t count,
+                           int *values, bool *found, size_t group_size = 8) const override;
     
     // 公开 hashKey 方法用于测试
     size_t hashKey(const std::string &key) const;
     
     // 获取指定位置的链
-    const std::vector<std::pair<std::string, int>>& getChainAt(size_t idx) const;
+    const std::vector<Entry>& getChainAt(size_t idx) const;
     
     // 获取特定键的探测次数
     int getProbeCount(const std::string &key) const;
     
+    // 按链下标顺序遍历所有表项的前向迭代器；插入/删除后失效
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Entry;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Entry *;
+        using reference = const Entry &;
+        
+        const_iterator() : table(nullptr), chain(0), pos(0) {}
+        const_iterator(const std::vector<std::vector<Entry>> *table, size_t chain)
+            : table(table), chain(chain), pos(0) { skipEmpty(); }
+        
+        reference operator*() const { return (*table)[chain][pos]; }
+        pointer operator->() const { return &(*table)[chain][pos]; }
+        const_iterator &operator++() {
+            ++pos;
+            skipEmpty();
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator old = *this;
+            ++*this;
+            return old;
+        }
+        bool operator==(const const_iterator &other) const { return chain == other.chain && pos == other.pos; }
+        bool operator!=(const const_iterator &other) const { return !(*this == other); }
+        
+    private:
+        const std::vector<std::vector<Entry>> *table;
+        size_t chain;
+        size_t pos;
+        
+        void skipEmpty() {
+            while (chain < table->size() && pos >= (*table)[chain].size()) {
+                chain++;
+                pos = 0;
+            }
+        }
+    };
+    
+    const_iterator begin() const { return const_iterator(&table, 0); }
+    const_iterator end() const { return const_iterator(&table, table.size()); }
+    
+    void forEach(const EntryVisitor &visit) const override;
+    // 按链下标切分区间，各线程顺序扫描自己负责的链
+    void parallelForEach(const EntryVisitor &visit, unsigned threads = 0) const override;
+    
 private:
     size_t capacity;
-    std::vector<std::vector<std::pair<std::string, int>>> table;
+    // 自组织模式下查找（const）也会调整链内顺序，因此链与命中计数是 mutable 的
+    mutable std::vector<std::vector<Entry>> table;
+    mutable std::vector<std::vector<uint32_t>> hit_counts; // 仅自组织模式使用，与 table 一一对应
     bool use_optimization; // 是否使用论文中的优化
+    
+    size_t recordHit(size_t idx, size_t pos) const;
+    // key_at(i) 返回第 i 个键，findBatch 与 findBatchHashed 共用同一个 AMAC 循环
+    template <class KeyAt>
+    size_t findBatchLoop(KeyAt key_at, const size_t *string_hashes, size_t count,
+                         int *values, bool *found, size_t group_size) const;
 };
 
+using SimpleHash = BasicSimpleHash<std::string>;
+
+// 实现位于 simple_hash.cpp，仅显式实例化以下 key 类型
+extern template class BasicSimpleHash<std::string>;
+extern template class BasicSimpleHash<InlineKey<8>>;
+extern template class BasicSimpleHash<InlineKey<16>>;
+
 #endif // SIMPLE_HASH_HPP
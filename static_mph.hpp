@@ -0,0 +1,189 @@
+#ifndef STATIC_MPH_HPP
+#define STATIC_MPH_HPP
+
+#include <array>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include "hash_key.hpp"
+
+// StaticPerfectHash 是编译期已知键集（关键字表、枚举名表等）的 minimal perfect hash：
+// 构造完全是 constexpr 的，声明为 constexpr 变量时 g、种子、键和值都在编译期算好，
+// 作为只读数据放进目标文件，启动时没有任何构造开销。
+// 构造算法与 MinimalPerfectHash 相同（2-图消除 + 逆序赋值），但种子按固定序列依次尝试，
+// 结果是确定的；消除时用"顶点度数 + 关联边编号异或"代替邻接表，只需定长数组。
+// 键重复或所有种子都失败时抛出异常，在常量求值中即为编译错误。
+template <size_t N>
+class StaticPerfectHash {
+    static_assert(N > 0, "StaticPerfectHash needs at least one key");
+    static_assert(N <= 0xFFFF, "StaticPerfectHash stores g as uint16_t");
+public:
+    static constexpr size_t kVertices = N * 5 / 2 + 2;
+    static constexpr int kMaxSeedAttempts = 1000;
+
+    // values 缺省时每个键的值就是它在 keys 中的下标
+    constexpr explicit StaticPerfectHash(const std::array<std::string_view, N> &keys)
+        : StaticPerfectHash(keys, identityValues()) {}
+
+    constexpr StaticPerfectHash(const std::array<std::string_view, N> &keys, const std::array<int, N> &values) {
+        if (hasDuplicate(keys))
+            throw std::invalid_argument("Duplicate key in StaticPerfectHash");
+        for (int attempt = 0; attempt < kMaxSeedAttempts; attempt++) {
+            seed = hashWords(N, attempt);
+            if (construct(keys)) {
+                // 按 hash 值重排键和值，查找时直接按下标核对
+                for (size_t i = 0; i < N; i++) {
+                    size_t slot = hash(keys[i]);
+                    slot_keys[slot] = keys[i];
+                    slot_values[slot] = values[i];
+                }
+                return;
+            }
+        }
+        throw std::runtime_error("Failed to construct StaticPerfectHash");
+    }
+
+    // 返回 key 对应的下标（范围 [0, N-1]）；不在键集中的 key 返回任意下标
+    constexpr size_t hash(std::string_view key) const {
+        uint64_t h = hashKey(key, seed);
+        return (g[vertexOf(h)] + g[vertexOf(h >> 32)]) % N;
+    }
+
+    constexpr bool contains(std::string_view key) const {
+        return slot_keys[hash(key)] == key;
+    }
+
+    constexpr int find(std::string_view key) const {
+        size_t slot = hash(key);
+        if (slot_keys[slot] != key)
+            throw std::runtime_error("Key not found in StaticPerfectHash");
+        return slot_values[slot];
+    }
+
+    static constexpr size_t size() { return N; }
+    constexpr uint64_t getSeed() const { return seed; }
+
+private:
+    std::array<uint16_t, kVertices> g{};
+    std::array<std::string_view, N> slot_keys{};
+    std::array<int, N> slot_values{};
+    uint64_t seed = 0;
+
+    static constexpr std::array<int, N> identityValues() {
+        std::array<int, N> values{};
+        for (size_t i = 0; i < N; i++)
+            values[i] = static_cast<int>(i);
+        return values;
+    }
+
+    // 重复键会让每个种子都失败；先按指纹排序，只比较指纹相同的相邻键，
+    // 避免两两比较在常量求值中超出操作数上限
+    static constexpr bool hasDuplicate(const std::array<std::string_view, N> &keys) {
+        std::array<uint64_t, N> fps{};
+        std::array<size_t, N> index{};
+        for (size_t i = 0; i < N; i++) {
+            fps[i] = hashKey(keys[i], 0);
+            index[i] = i;
+        }
+        for (size_t gap = N / 2; gap > 0; gap /= 2) {
+            for (size_t i = gap; i < N; i++) {
+                uint64_t fp = fps[i];
+                size_t idx = index[i];
+                size_t j = i;
+                for (; j >= gap && fps[j - gap] > fp; j -= gap) {
+                    fps[j] = fps[j - gap];
+                    index[j] = index[j - gap];
+                }
+                fps[j] = fp;
+                index[j] = idx;
+            }
+        }
+        for (size_t i = 1; i < N; i++) {
+            for (size_t j = i; j > 0 && fps[j - 1] == fps[i]; j--) {
+                if (keys[index[j - 1]] == keys[index[i]])
+                    return true;
+            }
+        }
+        return false;
+    }
+
+    // 逐字节读取，避免 memcpy，使其可在常量求值中使用
+    static constexpr uint64_t hashKey(std::string_view key, uint64_t seed) {
+        uint64_t h = seed ^ key.size();
+        uint64_t word = 0;
+        size_t i = 0;
+        for (; i < key.size(); i++) {
+            word |= static_cast<uint64_t>(static_cast<unsigned char>(key[i])) << (8 * (i % 8));
+            if (i % 8 == 7) {
+                h = hashWords(word, h, seed);
+                word = 0;
+            }
+        }
+        return hashWords(word, h, seed + 1);
+    }
+
+    static constexpr size_t vertexOf(uint64_t h) {
+        return static_cast<size_t>(((h & 0xFFFFFFFFULL) * kVertices) >> 32);
+    }
+
+    constexpr bool construct(const std::array<std::string_view, N> &keys) {
+        std::array<uint32_t, N> eu{}, ev{};
+        std::array<uint32_t, kVertices> deg{}, xr{}, stack{};
+        std::array<uint32_t, N> order_vertex{}, order_edge{};
+        for (size_t e = 0; e < N; e++) {
+            uint64_t h = hashKey(keys[e], seed);
+            eu[e] = static_cast<uint32_t>(vertexOf(h));
+            ev[e] = static_cast<uint32_t>(vertexOf(h >> 32));
+            if (eu[e] == ev[e])
+                return false;
+            deg[eu[e]]++;
+            deg[ev[e]]++;
+            xr[eu[e]] ^= static_cast<uint32_t>(e);
+            xr[ev[e]] ^= static_cast<uint32_t>(e);
+        }
+
+        size_t top = 0, peeled = 0;
+        for (size_t v = 0; v < kVertices; v++) {
+            if (deg[v] == 1)
+                stack[top++] = static_cast<uint32_t>(v);
+        }
+        while (top > 0) {
+            uint32_t v = stack[--top];
+            if (deg[v] != 1)
+                continue;
+            uint32_t e = xr[v];
+            uint32_t w = (eu[e] == v) ? ev[e] : eu[e];
+            order_vertex[peeled] = v;
+            order_edge[peeled] = e;
+            peeled++;
+            deg[v] = 0;
+            xr[w] ^= e;
+            if (--deg[w] == 1)
+                stack[top++] = w;
+        }
+        if (peeled != N)
+            return false;
+
+        g = {};
+        for (size_t i = N; i-- > 0;) {
+            uint32_t v = order_vertex[i];
+            uint32_t e = order_edge[i];
+            uint32_t w = (eu[e] == v) ? ev[e] : eu[e];
+            g[v] = static_cast<uint16_t>((e + N - g[w]) % N);
+        }
+        return true;
+    }
+};
+
+// 推导键数量的辅助函数：
+//   constexpr auto kKeywords = makeStaticPerfectHash({"if", "else", "while"});
+template <size_t N>
+constexpr StaticPerfectHash<N> makeStaticPerfectHash(const std::string_view (&keys)[N]) {
+    std::array<std::string_view, N> arr{};
+    for (size_t i = 0; i < N; i++)
+        arr[i] = keys[i];
+    return StaticPerfectHash<N>(arr);
+}
+
+#endif // STATIC_MPH_HPP
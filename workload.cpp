@@ -0,0 +1,303 @@
+#include "workload.hpp"
+#include <random>
+#include <cmath>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <unordered_set>
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+const std::string kKeyChars = "abcdefghijklmnopqrstuvwxyz";
+
+// Zipfian 生成器（Gray et al. "Quickly Generating Billion-Record Synthetic Databases"，
+// 与 YCSB 相同的算法），返回 [0, n) 中的秩，0 最热
+class ZipfianGenerator {
+public:
+    ZipfianGenerator(size_t n, double theta) : n(n), theta(theta) {
+        zetan = zeta(n, theta);
+        double zeta2 = zeta(2, theta);
+        alpha = 1.0 / (1.0 - theta);
+        eta = (1.0 - std::pow(2.0 / n, 1.0 - theta)) / (1.0 - zeta2 / zetan);
+    }
+    
+    size_t next(std::mt19937 &rng) {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        double uz = u * zetan;
+        if (uz < 1.0)
+            return 0;
+        if (uz < 1.0 + std::pow(0.5, theta))
+            return 1;
+        size_t rank = static_cast<size_t>(n * std::pow(eta * u - eta + 1.0, alpha));
+        return std::min(rank, n - 1);
+    }
+    
+private:
+    size_t n;
+    double theta, zetan, alpha, eta;
+    
+    static double zeta(size_t n, double theta) {
+        double sum = 0.0;
+        for (size_t i = 1; i <= n; i++)
+            sum += 1.0 / std::pow(static_cast<double>(i), theta);
+        return sum;
+    }
+};
+
+// 生成的键全局唯一，保证"未命中"查询确实不存在于表中
+class KeyGenerator {
+public:
+    KeyGenerator(const WorkloadConfig &config, std::mt19937 &rng) : config(config), rng(rng) {}
+    
+    std::string next() {
+        std::uniform_int_distribution<size_t> char_dist(0, kKeyChars.size() - 1);
+        while (true) {
+            size_t length = nextLength();
+            std::string key;
+            for (size_t i = 0; i < length; i++)
+                key.push_back(kKeyChars[char_dist(rng)]);
+            if (used.insert(key).second)
+                return key;
+        }
+    }
+    
+private:
+    const WorkloadConfig &config;
+    std::mt19937 &rng;
+    std::unordered_set<std::string> used;
+    
+    size_t nextLength() {
+        if (config.length_distribution == KeyLengthDistribution::Normal) {
+            std::normal_distribution<double> dist(config.mean_key_length, config.key_length_stddev);
+            double length = std::round(dist(rng));
+            length = std::max(length, static_cast<double>(config.min_key_length));
+            length = std::min(length, static_cast<double>(config.max_key_length));
+            return static_cast<size_t>(length);
+        }
+        return std::uniform_int_distribution<size_t>(config.min_key_length, config.max_key_length)(rng);
+    }
+};
+
+// 长度在 [min_length, max_length] 内的不同键的数量，超过 limit 时返回 limit
+size_t keySpace(size_t min_length, size_t max_length, size_t limit) {
+    size_t total = 0, count_at_length = 1;
+    for (size_t length = 0; length <= max_length && total < limit; length++) {
+        if (length >= min_length)
+            total += std::min(count_at_length, limit - total);
+        count_at_length = count_at_length > limit / kKeyChars.size() ? limit : count_at_length * kKeyChars.size();
+    }
+    return total;
+}
+
+// trace 中的键：空白、反斜杠、引号和不可打印字节写成 \xHH，空键写成 ""
+std::string escapeKey(const std::string &key) {
+    if (key.empty())
+        return "\"\"";
+    static const char kHex[] = "0123456789abcdef";
+    std::string out;
+    for (unsigned char c : key) {
+        if (c <= ' ' || c >= 0x7F || c == '\\' || c == '"') {
+            out += "\\x";
+            out.push_back(kHex[c >> 4]);
+            out.push_back(kHex[c & 0xF]);
+        } else {
+            out.push_back(static_cast<char>(c));
+        }
+    }
+    return out;
+}
+
+bool unescapeKey(const std::string &token, std::string &key) {
+    key.clear();
+    if (token == "\"\"")
+        return true;
+    for (size_t i = 0; i < token.size(); i++) {
+        if (token[i] != '\\') {
+            key.push_back(token[i]);
+            continue;
+        }
+        if (i + 3 >= token.size() || token[i + 1] != 'x' || !std::isxdigit(static_cast<unsigned char>(token[i + 2]))
+            || !std::isxdigit(static_cast<unsigned char>(token[i + 3])))
+            return false;
+        key.push_back(static_cast<char>(std::stoi(token.substr(i + 2, 2), nullptr, 16)));
+        i += 3;
+    }
+    return true;
+}
+
+char opCode(OpType type) {
+    switch (type) {
+    case OpType::Insert: return 'I';
+    case OpType::Erase: return 'E';
+    default: return 'L';
+    }
+}
+
+} // namespace
+
+Workload Workload::generate(const WorkloadConfig &config) {
+    if (config.key_count == 0)
+        throw std::invalid_argument("Workload needs at least one key");
+    if (config.insert_ratio + config.erase_ratio > 1.0)
+        throw std::invalid_argument("insert_ratio + erase_ratio exceeds 1");
+    // Zipfian 生成器的指数含 1 / (1 - theta)，theta 必须严格位于 (0, 1)
+    if (!(config.zipf_theta > 0.0 && config.zipf_theta < 1.0))
+        throw std::invalid_argument("zipf_theta must be in (0, 1)");
+    if (config.min_key_length > config.max_key_length)
+        throw std::invalid_argument("min_key_length exceeds max_key_length");
+    // 键全局唯一：预加载键之外，每个操作至多再生成一个新键（插入、未命中查询，
+    // 或删空后的插入）。键空间放不下时 KeyGenerator 会一直找不到未用过的键
+    size_t unique_keys = config.key_count;
+    if (config.insert_ratio > 0.0 || config.erase_ratio > 0.0 || config.miss_ratio > 0.0)
+        unique_keys += config.operation_count;
+    if (keySpace(config.min_key_length, config.max_key_length, unique_keys) < unique_keys)
+        throw std::invalid_argument("Key length range cannot hold " + std::to_string(unique_keys) + " unique keys");
+    
+    std::mt19937 rng(config.seed);
+    KeyGenerator keygen(config, rng);
+    Workload workload;
+    
+    // 存活键集合：前 key_count 个按秩排列，Zipfian/热点集的热键即秩靠前的键
+    std::vector<std::string> live;
+    for (size_t i = 0; i < config.key_count; i++) {
+        live.push_back(keygen.next());
+    }
+    workload.preload_keys = live;
+    
+    ZipfianGenerator zipf(config.key_count, config.zipf_theta);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    size_t hot_count = std::max<size_t>(1, static_cast<size_t>(config.key_count * config.hot_set_fraction));
+    
+    auto pick_live = [&]() -> size_t {
+        size_t rank;
+        switch (config.distribution) {
+        case AccessDistribution::Zipfian:
+            rank = zipf.next(rng);
+            break;
+        case AccessDistribution::HotSet:
+            if (unit(rng) < config.hot_access_fraction || hot_count >= live.size())
+                rank = std::uniform_int_distribution<size_t>(0, hot_count - 1)(rng);
+            else
+                rank = std::uniform_int_distribution<size_t>(hot_count, live.size() - 1)(rng);
+            break;
+        default:
+            rank = std::uniform_int_distribution<size_t>(0, live.size() - 1)(rng);
+            break;
+        }
+        // 删除会缩小存活集合，越界的秩折回到现有范围
+        return rank % live.size();
+    };
+    
+    workload.operations.reserve(config.operation_count);
+    for (size_t i = 0; i < config.operation_count; i++) {
+        double r = unit(rng);
+        if (r < config.insert_ratio || live.empty()) {
+            live.push_back(keygen.next());
+            workload.operations.push_back({OpType::Insert, live.back(), static_cast<int>(i)});
+        } else if (r < config.insert_ratio + config.erase_ratio) {
+            size_t idx = pick_live();
+            workload.operations.push_back({OpType::Erase, live[idx], 0});
+            live[idx] = live.back();
+            live.pop_back();
+        } else if (unit(rng) < config.miss_ratio) {
+            workload.operations.push_back({OpType::Lookup, keygen.next(), 0});
+        } else {
+            workload.operations.push_back({OpType::Lookup, live[pick_live()], 0});
+        }
+    }
+    return workload;
+}
+
+Workload Workload::loadTrace(const std::string &path) {
+    std::ifstream in(path);
+    if (!in)
+        throw std::runtime_error("Cannot open trace file: " + path);
+    
+    Workload workload;
+    std::string line;
+    size_t line_no = 0;
+    while (std::getline(in, line)) {
+        line_no++;
+        if (line.empty() || line[0] == '#')
+            continue;
+        std::istringstream fields(line);
+        std::string op, token, key;
+        int value = 0;
+        std::string malformed = "Malformed trace line " + std::to_string(line_no) + ": " + line;
+        if (!(fields >> op >> token) || op.size() != 1 || !unescapeKey(token, key))
+            throw std::runtime_error(malformed);
+        switch (op[0]) {
+        case 'P':
+            workload.preload_keys.push_back(key);
+            break;
+        case 'I':
+            if (!(fields >> value))
+                throw std::runtime_error(malformed);
+            workload.operations.push_back({OpType::Insert, key, value});
+            break;
+        case 'E':
+            workload.operations.push_back({OpType::Erase, key, 0});
+            break;
+        case 'L':
+            workload.operations.push_back({OpType::Lookup, key, 0});
+            break;
+        default:
+            throw std::runtime_error("Unknown trace op on line " + std::to_string(line_no) + ": " + op);
+        }
+    }
+    return workload;
+}
+
+void Workload::saveTrace(const std::string &path) const {
+    std::ofstream out(path);
+    if (!out)
+        throw std::runtime_error("Cannot write trace file: " + path);
+    for (const auto &key : preload_keys) {
+        out << "P " << escapeKey(key) << "\n";
+    }
+    for (const auto &op : operations) {
+        out << opCode(op.type) << " " << escapeKey(op.key);
+        if (op.type == OpType::Insert)
+            out << " " << op.value;
+        out << "\n";
+    }
+}
+
+ReplayResult Workload::replay(AbstractHash &table) const {
+    for (size_t i = 0; i < preload_keys.size(); i++) {
+        table.insert(preload_keys[i], static_cast<int>(i));
+    }
+    
+    // 未命中走 tryFind / contains，不抛异常，计时只包含表本身的开销
+    ReplayResult result{0, 0, 0};
+    volatile int sum = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (const auto &op : operations) {
+        bool hit = true;
+        int value;
+        switch (op.type) {
+        case OpType::Insert:
+            table.insert(op.key, op.value);
+            break;
+        case OpType::Erase:
+            hit = table.contains(op.key);
+            if (hit)
+                table.erase(op.key);
+            break;
+        case OpType::Lookup:
+            hit = table.tryFind(op.key, value);
+            if (hit)
+                sum += value;
+            break;
+        }
+        if (hit)
+            result.hits++;
+        else
+            result.misses++;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    result.elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    return result;
+}
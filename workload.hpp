@@ -0,0 +1,77 @@
+#ifndef WORKLOAD_HPP
+#define WORKLOAD_HPP
+
+#include "abstract_hash.hpp"
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+// 基准测试的负载：预加载键集 + 按顺序回放的操作序列。
+// 既可按配置生成（均匀 / Zipfian / 热点集访问、未命中比例、键长分布、
+// 插入/删除/查询混合），也可从记录的 trace 文件加载。
+
+enum class OpType { Insert, Erase, Lookup };
+
+struct Operation {
+    OpType type;
+    std::string key;
+    int value;
+};
+
+enum class AccessDistribution { Uniform, Zipfian, HotSet };
+enum class KeyLengthDistribution { Uniform, Normal };
+
+struct WorkloadConfig {
+    size_t key_count = 10000;           // 预加载的键数量
+    size_t operation_count = 100000;    // 回放的操作数量
+    double insert_ratio = 0.0;          // 插入新键的操作比例
+    double erase_ratio = 0.0;           // 删除已有键的操作比例，其余为查询
+    double miss_ratio = 0.0;            // 查询中访问不存在键的比例
+    
+    AccessDistribution distribution = AccessDistribution::Uniform;
+    double zipf_theta = 0.99;           // Zipfian 偏斜参数，(0, 1)
+    double hot_set_fraction = 0.2;      // 热点集占键集的比例
+    double hot_access_fraction = 0.8;   // 落在热点集上的访问比例
+    
+    KeyLengthDistribution length_distribution = KeyLengthDistribution::Uniform;
+    size_t min_key_length = 7;
+    size_t max_key_length = 10;
+    double mean_key_length = 8.0;       // 仅 Normal 分布使用，结果截断到 [min, max]
+    double key_length_stddev = 2.0;
+    
+    uint32_t seed = 42;
+};
+
+struct ReplayResult {
+    long long elapsed_ms;
+    size_t hits;
+    size_t misses;
+};
+
+class Workload {
+public:
+    static Workload generate(const WorkloadConfig &config);
+    
+    // trace 文件每行一个操作：
+    //   P <key>          预加载（不计时）
+    //   I <key> <value>  插入
+    //   E <key>          删除
+    //   L <key>          查询
+    // 键中的空白、反斜杠、引号和不可打印字节写成 \xHH，空键写成 ""；
+    // 空行和以 # 开头的行被忽略
+    static Workload loadTrace(const std::string &path);
+    void saveTrace(const std::string &path) const;
+    
+    const std::vector<std::string>& getPreloadKeys() const { return preload_keys; }
+    const std::vector<Operation>& getOperations() const { return operations; }
+    
+    // 先预加载，再计时回放全部操作；查询和删除未命中计入 misses
+    ReplayResult replay(AbstractHash &table) const;
+    
+private:
+    std::vector<std::string> preload_keys;
+    std::vector<Operation> operations;
+};
+
+#endif // WORKLOAD_HPP